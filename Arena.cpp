@@ -0,0 +1,108 @@
+#include "Arena.h"
+#include <cstdlib>
+#include <new>
+
+#define ARENA_ALIGNMENT 16
+
+namespace syn
+{
+  namespace
+  {
+    thread_local Arena* currentArena = nullptr;
+
+    /**
+     * Precedes every block returned by arenaAlloc(), recording where the block came from. Padded to keep the block
+     * aligned.
+     */
+    struct BlockHeader
+    {
+      Arena* arena; //!< nullptr for heap blocks
+      char padding[ARENA_ALIGNMENT - sizeof(Arena*)];
+    };
+
+    inline size_t alignUp(size_t size)
+    {
+      return (size + ARENA_ALIGNMENT - 1) & ~size_t(ARENA_ALIGNMENT - 1);
+    }
+  }
+
+  Arena::Scope::Scope(Arena* arena) :
+    m_previous(currentArena)
+  {
+    currentArena = arena;
+  }
+
+  Arena::Scope::~Scope()
+  {
+    currentArena = m_previous;
+  }
+
+  Arena::Arena(size_t chunksize) :
+    m_cursor(nullptr),
+    m_remaining(0),
+    m_chunkSize(chunksize),
+    m_bytesAllocated(0)
+  {}
+
+  Arena::~Arena()
+  {
+    for (int i = 0; i < m_chunks.size(); i++)
+    {
+      free(m_chunks[i]);
+    }
+  }
+
+  void* Arena::allocate(size_t size)
+  {
+    size = alignUp(size);
+    if (size > m_remaining)
+    {
+      size_t chunksize = size > m_chunkSize ? size : m_chunkSize;
+      char* chunk = static_cast<char*>(malloc(chunksize));
+      if (!chunk)
+        throw std::bad_alloc();
+      m_chunks.push_back(chunk);
+      m_cursor = chunk;
+      m_remaining = chunksize;
+    }
+    void* ptr = m_cursor;
+    m_cursor += size;
+    m_remaining -= size;
+    m_bytesAllocated += size;
+    return ptr;
+  }
+
+  Arena* Arena::current()
+  {
+    return currentArena;
+  }
+
+  void* arenaAlloc(size_t size)
+  {
+    Arena* arena = currentArena;
+    BlockHeader* header;
+    if (arena)
+    {
+      header = static_cast<BlockHeader*>(arena->allocate(sizeof(BlockHeader) + size));
+    }
+    else
+    {
+      header = static_cast<BlockHeader*>(malloc(sizeof(BlockHeader) + size));
+      if (!header)
+        throw std::bad_alloc();
+    }
+    header->arena = arena;
+    return header + 1;
+  }
+
+  void arenaFree(void* ptr)
+  {
+    if (!ptr)
+      return;
+    BlockHeader* header = static_cast<BlockHeader*>(ptr) - 1;
+    if (!header->arena)
+    {
+      free(header);
+    }
+  }
+}
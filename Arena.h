@@ -0,0 +1,107 @@
+#ifndef __ARENA__
+#define __ARENA__
+#include <cstddef>
+#include <vector>
+
+#define ARENA_CHUNK_SIZE 65536 //!< default number of bytes an Arena reserves from the heap at a time
+
+namespace syn
+{
+  /**
+   * \class Arena
+   *
+   * \brief Bump allocator owning the memory of a group of objects that are released together, such as a voice.
+   *
+   * Allocations are carved sequentially out of large chunks, so objects created one after the other (a unit, its
+   * parameters and its buffers) are laid out next to each other. Freeing an individual allocation does nothing; all
+   * of the memory is returned at once when the arena is destroyed, which must happen after every object allocated
+   * from it has been destroyed.
+   *
+   * Constructors do not take an arena. Instead, while an Arena::Scope is alive on a thread, arenaAlloc() on that
+   * thread (and with it the operator new of ArenaAllocated classes and the ArenaAllocator used by SampleVec) allocates
+   * from the scope's arena. Outside of any scope, it allocates from the heap as usual.
+   */
+  class Arena
+  {
+  public:
+    /**
+     * \brief Makes an arena the current thread's allocation target for the lifetime of the scope.
+     */
+    class Scope
+    {
+    public:
+      Scope(Arena* arena);
+      ~Scope();
+    private:
+      Arena* m_previous;
+    };
+
+    Arena(size_t chunksize = ARENA_CHUNK_SIZE);
+    ~Arena();
+    /**
+     * \brief Returns size bytes aligned to 16 bytes. Only released when the arena is destroyed.
+     */
+    void* allocate(size_t size);
+    size_t getBytesAllocated() const { return m_bytesAllocated; }
+    static Arena* current();
+  private:
+    Arena(const Arena&);
+    Arena& operator=(const Arena&);
+
+    std::vector<char*> m_chunks;
+    char* m_cursor;
+    size_t m_remaining;
+    size_t m_chunkSize;
+    size_t m_bytesAllocated;
+  };
+
+  /**
+   * \brief Allocates from the current thread's arena if there is one, otherwise from the heap. Throws std::bad_alloc.
+   */
+  void* arenaAlloc(size_t size);
+  /**
+   * \brief Frees memory returned by arenaAlloc(). Heap allocations are freed immediately, arena allocations when
+   * their arena is destroyed.
+   */
+  void arenaFree(void* ptr);
+
+  /**
+   * \class ArenaAllocated
+   *
+   * \brief Base class which makes new and delete go through arenaAlloc() and arenaFree().
+   */
+  class ArenaAllocated
+  {
+  public:
+    static void* operator new(size_t size) { return arenaAlloc(size); }
+    static void operator delete(void* ptr) { arenaFree(ptr); }
+  };
+
+  /**
+   * \class ArenaAllocator
+   *
+   * \brief Standard library allocator that goes through arenaAlloc() and arenaFree().
+   */
+  template <typename T>
+  class ArenaAllocator
+  {
+  public:
+    typedef T value_type;
+    template <typename U>
+    struct rebind
+    {
+      typedef ArenaAllocator<U> other;
+    };
+
+    ArenaAllocator() {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>&) {}
+    T* allocate(size_t n) { return static_cast<T*>(arenaAlloc(n * sizeof(T))); }
+    void deallocate(T* ptr, size_t) { arenaFree(ptr); }
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>&) const { return false; }
+  };
+}
+#endif
@@ -2,9 +2,15 @@
 #include <stdexcept>
 #include <vector>
 #include <unordered_set>
+#include <algorithm>
+#include <chrono>
+#include <typeinfo>
+
+#ifndef DBGMSG
+#define DBGMSG(...)
+#endif
 
 using std::vector;
-using std::deque;
 using std::unordered_set;
 namespace syn
 {
@@ -29,6 +35,9 @@ namespace syn
       unit->m_parent = this;
       unit->resizeOutputBuffer(m_bufsize);
       unit->setFs(m_Fs);
+      // a unit without connections can go anywhere in the order
+      m_topoIndex[uid] = m_topoOrder.size();
+      m_topoOrder.push_back(uid);
       m_isGraphDirty = true;
       while (m_units.find(m_nextUid) != m_units.end())
       {
@@ -78,6 +87,27 @@ namespace syn
 
       m_forwardConnections.erase(uid);
       m_backwardConnections.erase(uid);
+
+      // Removing a unit never invalidates the order of the remaining units
+      int pos = m_topoIndex[uid];
+      m_topoOrder.erase(m_topoOrder.begin() + pos);
+      m_topoIndex.erase(uid);
+      for (int i = pos; i < m_topoOrder.size(); i++)
+      {
+        m_topoIndex[m_topoOrder[i]] = i;
+      }
+      // ...but it may have broken cycles, so feedback connections that no longer close one become regular connections
+      vector<ConnectionMetadata> feedback(m_feedbackConnections);
+      for (int i = 0; i < feedback.size(); i++)
+      {
+        ConnectionMetadata& c = feedback[i];
+        m_feedbackConnections.erase(find(m_feedbackConnections.begin(), m_feedbackConnections.end(), c));
+        if (c.srcid == uid || c.targetid == uid)
+          continue;
+        if (!insertIntoOrder(c.srcid, c.targetid))
+          m_feedbackConnections.push_back(c);
+      }
+
       m_unitmap.erase(m_units[uid]->getName());
       Unit* unit = m_units[uid];
       m_units.erase(uid);
@@ -158,7 +188,12 @@ namespace syn
       vector<ConnectionMetadata>& bl = m_backwardConnections[c.targetid];
       fl.push_back(c);
       bl.push_back(c);
-      m_units[c.targetid]->m_params[c.portid]->addConnection(&(m_units[c.srcid]->getLastOutputBuffer()), c.action);
+      m_units[c.targetid]->m_params[c.portid]->addConnection(&(m_units[c.srcid]->getLastOutputBuffer()), c.action, &m_units[c.srcid]->m_outputFlags,
+        m_units[c.srcid]->getNumChannels());
+      if (!insertIntoOrder(c.srcid, c.targetid))
+      {
+        m_feedbackConnections.push_back(c);
+      }
       m_isGraphDirty = true;
     }
     return true;
@@ -172,47 +207,231 @@ namespace syn
     return addConnection({ sourceid,targetid,paramid,action });
   }
 
+  bool Circuit::isFeedbackConnection(int srcid, int targetid) const
+  {
+    for (int i = 0; i < m_feedbackConnections.size(); i++)
+    {
+      if (m_feedbackConnections[i].srcid == srcid && m_feedbackConnections[i].targetid == targetid)
+        return true;
+    }
+    return false;
+  }
+
+  bool Circuit::insertIntoOrder(int srcid, int targetid)
+  {
+    int lb = m_topoIndex.at(targetid);
+    int ub = m_topoIndex.at(srcid);
+    if (ub < lb)
+    {
+      return true; // source already precedes target
+    }
+
+    // Units in the affected region [lb, ub] that depend on the target. Reaching the source means a cycle.
+    vector<int> deltaF;
+    unordered_set<int> visited({ targetid });
+    vector<int> stack({ targetid });
+    while (!stack.empty())
+    {
+      int uid = stack.back();
+      stack.pop_back();
+      deltaF.push_back(uid);
+      const vector<ConnectionMetadata>& conns = m_forwardConnections.at(uid);
+      for (int i = 0; i < conns.size(); i++)
+      {
+        int next = conns[i].targetid;
+        if (isFeedbackConnection(uid, next))
+          continue;
+        if (next == srcid)
+          return false;
+        if (m_topoIndex.at(next) < ub && !visited.count(next))
+        {
+          visited.insert(next);
+          stack.push_back(next);
+        }
+      }
+    }
+
+    // Units in the affected region that the source depends on
+    vector<int> deltaB;
+    visited = { srcid };
+    stack.push_back(srcid);
+    while (!stack.empty())
+    {
+      int uid = stack.back();
+      stack.pop_back();
+      deltaB.push_back(uid);
+      const vector<ConnectionMetadata>& conns = m_backwardConnections.at(uid);
+      for (int i = 0; i < conns.size(); i++)
+      {
+        int next = conns[i].srcid;
+        if (m_topoIndex.at(next) > lb && !visited.count(next) && !isFeedbackConnection(next, uid))
+        {
+          visited.insert(next);
+          stack.push_back(next);
+        }
+      }
+    }
+
+    // Reassign the positions held by both sets so that every unit of deltaB precedes every unit of deltaF, keeping
+    // the relative order within each set.
+    auto byIndex = [this](int a, int b) { return m_topoIndex.at(a) < m_topoIndex.at(b); };
+    std::sort(deltaF.begin(), deltaF.end(), byIndex);
+    std::sort(deltaB.begin(), deltaB.end(), byIndex);
+    vector<int> positions;
+    for (int i = 0; i < deltaB.size(); i++)
+    {
+      positions.push_back(m_topoIndex.at(deltaB[i]));
+    }
+    for (int i = 0; i < deltaF.size(); i++)
+    {
+      positions.push_back(m_topoIndex.at(deltaF[i]));
+    }
+    std::sort(positions.begin(), positions.end());
+    deltaB.insert(deltaB.end(), deltaF.begin(), deltaF.end());
+    for (int i = 0; i < deltaB.size(); i++)
+    {
+      m_topoOrder[positions[i]] = deltaB[i];
+      m_topoIndex[deltaB[i]] = positions[i];
+    }
+    return true;
+  }
+
   void Circuit::refreshProcQueue()
   {
-    unordered_set<int> closed_set;
-    deque<int> dependencyQueue({ m_sinkId });
-    deque<int>& processQueue = m_processQueue;
-    processQueue.clear();
-    while (!dependencyQueue.empty())
-    {
-      int currUnit = dependencyQueue.back();
-      dependencyQueue.pop_back();
-      processQueue.push_front(currUnit);
-      if (!m_backwardConnections[currUnit].size())
-        continue;
-      for (int i = 0; i < m_backwardConnections[currUnit].size(); i++)
+    // Only the units the sink depends on are processed
+    unordered_set<int> required({ m_sinkId });
+    vector<int> stack({ m_sinkId });
+    while (!stack.empty())
+    {
+      int uid = stack.back();
+      stack.pop_back();
+      const vector<ConnectionMetadata>& conns = m_backwardConnections[uid];
+      for (int i = 0; i < conns.size(); i++)
       {
-        int sourceid = m_backwardConnections[currUnit][i].srcid;
-        if (closed_set.find(sourceid) == closed_set.end())
+        if (required.insert(conns[i].srcid).second)
         {
-          dependencyQueue.push_front(sourceid);
-          closed_set.insert(sourceid);
+          stack.push_back(conns[i].srcid);
         }
       }
     }
+
+    m_processQueue.clear();
+    for (int i = 0; i < m_topoOrder.size(); i++)
+    {
+      if (required.count(m_topoOrder[i]))
+      {
+        m_processQueue.push_back(m_topoOrder[i]);
+      }
+    }
   }
 
-  void Circuit::tick()
+  void Circuit::computeLevels()
   {
-    if (m_sinkId < 0)
+    unordered_map<int, int> levels;
+    int numlevels = 0;
+    for (int currUnitId : m_processQueue)
     {
-      return;
+      int level = 0;
+      // after the sources of its regular connections...
+      const vector<ConnectionMetadata>& bwconns = m_backwardConnections[currUnitId];
+      for (int i = 0; i < bwconns.size(); i++)
+      {
+        if (levels.count(bwconns[i].srcid) && !isFeedbackConnection(bwconns[i].srcid, currUnitId))
+          level = std::max(level, levels[bwconns[i].srcid] + 1);
+      }
+      // ...and after the targets of its feedback connections, which must read its output from the previous block
+      const vector<ConnectionMetadata>& fwconns = m_forwardConnections[currUnitId];
+      for (int i = 0; i < fwconns.size(); i++)
+      {
+        if (levels.count(fwconns[i].targetid) && isFeedbackConnection(currUnitId, fwconns[i].targetid))
+          level = std::max(level, levels[fwconns[i].targetid] + 1);
+      }
+      levels[currUnitId] = level;
+      numlevels = std::max(numlevels, level + 1);
     }
-    if (m_isGraphDirty)
+
+    m_levelStarts.assign(numlevels + 1, 0);
+    for (int currUnitId : m_processQueue)
+    {
+      m_levelStarts[levels[currUnitId] + 1]++;
+    }
+    for (int i = 1; i <= numlevels; i++)
+    {
+      m_levelStarts[i] += m_levelStarts[i - 1];
+    }
+    vector<int> fill(m_levelStarts.begin(), m_levelStarts.end() - 1);
+    m_schedule.resize(m_processQueue.size());
+    for (int currUnitId : m_processQueue)
+    {
+      m_schedule[fill[levels[currUnitId]]++] = m_units.at(currUnitId);
+    }
+  }
+
+  void Circuit::compile()
+  {
+    m_schedule.clear();
+    m_levelStarts.assign(1, 0);
+    m_sink = nullptr;
+    if (m_sinkId >= 0)
     {
       refreshProcQueue();
-      m_isGraphDirty = false;
+      computeLevels();
+      m_sink = m_units.at(m_sinkId);
     }
+    m_unitCost.assign(m_schedule.size(), 0.0);
+    m_isGraphDirty = false;
+  }
 
-    for (int currUnitId : m_processQueue)
+  void Circuit::tickScheduledUnit(void* circuit, int schedind)
+  {
+    Circuit* self = static_cast<Circuit*>(circuit);
+    int i = self->m_jobOffset + schedind;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    self->m_schedule[i]->tick(self->m_tickSize);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    self->m_unitCost[i] += 0.1 * (elapsed - self->m_unitCost[i]);
+  }
+
+  void Circuit::tick(size_t n, WorkerPool* pool)
+  {
+    if (m_isGraphDirty)
     {
-      Unit& source = *m_units[currUnitId];
-      source.tick();
+      compile();
+    }
+    int numlevels = m_levelStarts.size() - 1;
+    if (!pool || pool->getNumThreads() == 0 || numlevels == m_schedule.size())
+    {
+      Unit* const* schedule = m_schedule.data();
+      size_t numunits = m_schedule.size();
+      for (int i = 0; i < numunits; i++)
+      {
+        schedule[i]->tick(n);
+      }
+      return;
+    }
+
+    m_tickSize = n;
+    for (int level = 0; level < numlevels; level++)
+    {
+      int begin = m_levelStarts[level];
+      int end = m_levelStarts[level + 1];
+      double cost = 0;
+      for (int i = begin; i < end; i++)
+      {
+        cost += m_unitCost[i];
+      }
+      m_jobOffset = begin;
+      if (end - begin > 1 && cost >= MIN_PARALLEL_LEVEL_COST)
+      {
+        pool->run(&Circuit::tickScheduledUnit, this, end - begin);
+      }
+      else
+      {
+        for (int i = 0; i < end - begin; i++)
+        {
+          tickScheduledUnit(this, i);
+        }
+      }
     }
   }
 
@@ -255,12 +474,27 @@ namespace syn
         circ->addConnection(connpair.second[j]);
       }
     }
-    circ->m_isGraphDirty = m_isGraphDirty;
-    circ->m_processQueue = m_processQueue;
+    // keep the same order and feedback connections, which could otherwise depend on the order of insertion
+    circ->m_topoOrder = m_topoOrder;
+    circ->m_topoIndex = m_topoIndex;
+    circ->m_feedbackConnections = m_feedbackConnections;
     circ->m_nextUid = m_nextUid;
+    circ->compile();
     return circ;
   }
 
+  void Circuit::copyState(const Circuit& other)
+  {
+    for (std::pair<int, Unit*> unitpair : m_units)
+    {
+      UnitVec::const_iterator it = other.m_units.find(unitpair.first);
+      if (it != other.m_units.end() && typeid(*it->second) == typeid(*unitpair.second))
+      {
+        unitpair.second->copyState(*it->second);
+      }
+    }
+  }
+
   bool Circuit::hasUnit(string name) const
   {
     return m_unitmap.find(name) != m_unitmap.end();
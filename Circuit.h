@@ -3,11 +3,14 @@
 
 #include "Unit.h"
 #include "UnitParameter.h"
+#include "WorkerPool.h"
 #include <list>
 #include <map>
 #include <deque>
 #include <tuple>
 
+#define MIN_PARALLEL_LEVEL_COST 2e-5 //!< estimated seconds of work below which a dependency level is processed serially
+
 namespace syn
 {
   using std::list;
@@ -36,18 +39,32 @@ namespace syn
   * The signal flow of a Circuit starts at the Units without incoming connections (sources) and flows towards the Unit
   * marked as the sink. The output of the Circuit is the output of the sink.
   *
+  * Units are processed in a topological order of the connection graph, which is maintained incrementally as units
+  * and connections are added or removed. A connection that would close a cycle is marked as a feedback connection:
+  * its target is processed before its source, and so receives the source's output from the previous block (a delay
+  * of exactly one block).
+  *
   */
-  class Circuit
+  class Circuit : public ArenaAllocated
   {
   public:
     Circuit() :
       m_nextUid(0),
       m_bufsize(1),
       m_sinkId(-1),
-      m_Fs(48e3)
+      m_Fs(48e3),
+      m_sink(nullptr),
+      m_jobOffset(0),
+      m_tickSize(1)
     {}
     virtual ~Circuit();
     Circuit* clone();
+    /**
+     * \brief Hands the running state of each unit of other to the unit of this circuit with the same id, if it is of
+     * the same class. Used to carry sounding notes over to a voice rebuilt from an edited patch.
+     * \sa Unit::copyState
+     */
+    void copyState(const Circuit& other);
     int addUnit(Unit* unit);
     int addUnit(Unit* unit, int uid);
     virtual bool removeUnit(int uid);
@@ -77,16 +94,33 @@ namespace syn
     vector<int> getUnitIds() const;
     /**
      * \brief Generate the requested number of samples. The result can be retrieved using getLastOutputBuffer()
+     *
+     * If a worker pool is given, the independent units of each dependency level are processed in parallel, unless the
+     * level's estimated cost is below MIN_PARALLEL_LEVEL_COST, in which case waking the workers would cost more than
+     * it saves. The pool must not be running another batch, so it cannot be used to render several circuits at once.
      */
-    void tick();
+    void tick(WorkerPool* pool = nullptr) { tick(m_bufsize, pool); }
+    /**
+     * \brief Generate only the first n samples of the buffer, where n is at most the buffer size.
+     */
+    void tick(size_t n, WorkerPool* pool = nullptr);
     void setFs(double fs);
     void setBufSize(size_t bufsize);
     size_t getBufSize() { return m_bufsize; }
     bool hasUnit(string name) const;
     bool hasUnit(int uid) const;
-    double getLastOutput() const { return m_units.at(m_sinkId)->getLastOutput(); };
-    const vector<double>& getLastOutputBuffer() const { return m_units.at(m_sinkId)->getLastOutputBuffer(); };
+    double getLastOutput() const { return getSink().getLastOutput(); };
+    const SampleVec& getLastOutputBuffer() const { return getSink().getLastOutputBuffer(); };
+    /**
+     * \brief Number of channels of the circuit's output, which are those of the sink.
+     */
+    int getNumChannels() const { return getSink().getNumChannels(); }
+    const Sample* getOutputChannel(int c) const { return getSink().getOutputChannel(c); }
     const vector<ConnectionMetadata>& getConnectionsTo(int unitid) const;
+    /**
+     * \brief Connections that close a cycle, and are therefore delayed by one block.
+     */
+    const vector<ConnectionMetadata>& getFeedbackConnections() const { return m_feedbackConnections; }
   protected:
     typedef  unordered_map<int, Unit*> UnitVec;
     typedef  unordered_map<int, vector<ConnectionMetadata>> ConnVec;
@@ -94,14 +128,47 @@ namespace syn
     ConnVec m_forwardConnections;
     ConnVec m_backwardConnections;
     IDMap m_unitmap;
-    deque<int> m_processQueue; //!< cache storage for the linearized version of unit dependencies
+    vector<int> m_topoOrder; //!< every unit, in an order in which each unit follows the sources of its non-feedback connections
+    unordered_map<int, int> m_topoIndex; //!< position of each unit in m_topoOrder
+    vector<ConnectionMetadata> m_feedbackConnections;
+    vector<int> m_processQueue; //!< units the sink depends on, in topological order
     bool m_isGraphDirty = true; //!< indicates whether or not the graph's linearization should be recomputed
     int m_sinkId;
     size_t m_bufsize;
     double m_Fs;
     int m_nextUid;
+
+    /*
+     * Compiled runtime schedule. Rebuilt by compile() from the editable graph above whenever m_isGraphDirty is set,
+     * so that processing never needs to look units up by id.
+     */
+    vector<Unit*> m_schedule; //!< units in processing order, grouped by dependency level
+    vector<int> m_levelStarts; //!< index in m_schedule of the first unit of each level, plus one past the last unit
+    vector<double> m_unitCost; //!< moving average of each scheduled unit's processing time, in seconds
+    Unit* m_sink;
+    /**
+     * \brief Rebuilds the runtime schedule from the graph and clears m_isGraphDirty.
+     */
+    virtual void compile();
   private:
     void refreshProcQueue();
+    /**
+     * \brief Updates the topological order to account for a new connection from srcid to targetid.
+     *
+     * Uses the Pearce-Kelly algorithm, which only reorders the units between the target and the source.
+     * \returns false, leaving the order untouched, if the connection closes a cycle.
+     */
+    bool insertIntoOrder(int srcid, int targetid);
+    bool isFeedbackConnection(int srcid, int targetid) const;
+    /**
+     * \brief Sorts the process queue into dependency levels. Units in the same level do not read each other's output
+     * during the block (feedback connections included), so they can be processed concurrently.
+     */
+    void computeLevels();
+    static void tickScheduledUnit(void* circuit, int schedind);
+    int m_jobOffset; //!< index in m_schedule of the first unit of the level being processed by the worker pool
+    size_t m_tickSize; //!< number of samples being processed by the worker pool
+    const Unit& getSink() const { return m_isGraphDirty || !m_sink ? *m_units.at(m_sinkId) : *m_sink; }
 
     virtual Circuit* cloneImpl() const { return new Circuit(); };
   };
@@ -2,13 +2,13 @@
 #include "UI.h"
 #include "VOSIMSynth.h"
 #include "mutex.h"
+#include "PatchLoader.h"
 
 namespace syn
 {
   void CircuitPanel::updateInstrument() const
   {
-    IPlugBase::IMutexLock lock(mPlug);
-    m_vm->setMaxVoices(m_vm->getMaxVoices(), m_vm->getProtoInstrument());
+    m_vm->rebuildVoices();
   }
 
   void CircuitPanel::deleteUnit(int unitctrlid)
@@ -272,6 +272,12 @@ namespace syn
         serialized.Put<ConnectionMetadata>(&connections[j]);
       }
     }
+
+    // Write the settings added since the original format, tagged so that their absence can be detected
+    unsigned int tag = PATCH_OVERSAMPLING_TAG;
+    int oversampling = instr->getOversampling();
+    serialized.Put<unsigned int>(&tag);
+    serialized.Put<int>(&oversampling);
     return serialized;
   }
 
@@ -304,6 +310,20 @@ namespace syn
         instr->addConnection(conn);
       }
     }
+
+    // Unserialize optional settings
+    unsigned int tag = 0;
+    int oversampling = 1;
+    if (serialized->Size() - chunkpos >= int(sizeof(unsigned int) + sizeof(int)))
+    {
+      serialized->Get<unsigned int>(&tag, chunkpos);
+    }
+    if (tag == PATCH_OVERSAMPLING_TAG)
+    {
+      chunkpos = serialized->Get<unsigned int>(&tag, chunkpos);
+      chunkpos = serialized->Get<int>(&oversampling, chunkpos);
+    }
+    m_vm->setOversampling(oversampling);
     updateInstrument();
     return chunkpos;
   }
@@ -1,6 +1,7 @@
 #ifndef __DSPMATH__
 #define __DSPMATH__
 #include "tables.h"
+#include <cstddef>
 
 #define LERP(A,B,F) (((B)-(A))*(F)+(A))
 #define INVLERP(A,B,X) (((X)-(A))/((B)-(A)))
@@ -19,12 +20,30 @@ namespace syn
 
   inline double pitchToFreq(double pitch)
   {
-    double freq = lut_pitch_table.getlinear(pitch*0.0078125);
+    double freq = lut_pitch_table().getlinear(pitch*0.0078125);
     if (freq == 0)
       freq = 1;
     return freq;
   }
 
+  /**
+   * \brief Block version of pitchToFreq, for double or float samples. pitch and freq may point to the same buffer.
+   */
+  template<typename T>
+  inline void pitchToFreq(const T* pitch, T* freq, size_t n)
+  {
+    for (int i = 0; i < n; i++)
+    {
+      freq[i] = pitch[i]*T(0.0078125);
+    }
+    lut_pitch_table().getlinear(freq, freq, n);
+    for (int i = 0; i < n; i++)
+    {
+      if (freq[i] == 0)
+        freq[i] = 1;
+    }
+  }
+
   template<typename T>
   inline T max(T a1, T a2)
   {
@@ -36,11 +55,5 @@ namespace syn
   {
     return a1 < a2 ? a1 : a2;
   }
-
-  inline IRECT shiftIRECT(const IRECT& a_irect, int a_x, int a_y)
-  {
-    IRECT shifted{a_irect.L + a_x, a_irect.T + a_y, a_irect.R + a_x, a_irect.B + a_y};
-    return shifted;
-  }
 }
 #endif
@@ -1,5 +1,6 @@
 #include "Envelope.h"
 #include <sstream>
+#include <cmath>
 #include "tables.h"
 using std::ostringstream;
 /******************************
@@ -15,7 +16,8 @@ namespace syn
     m_numSegments(numSegments),
     m_currSegment(0),
     m_isDone(true),
-    m_phase(0)
+    m_phase(0),
+    m_amp(0)
   {
     // set up a standard ADSR envelope
     ostringstream paramname;
@@ -52,6 +54,7 @@ namespace syn
     m_initPoint = env.m_initPoint;
     m_isDone = env.m_isDone;
     m_phase = env.m_phase;
+    m_amp = env.m_amp;
   }
 
   Envelope::~Envelope()
@@ -75,56 +78,71 @@ namespace syn
 
   void Envelope::updateSegment(int segment)
   {
-    if (m_segments[segment]->period().isDirty() || m_fsIsDirty) {
-      m_segments[segment]->step = 1. / (m_Fs*(m_segments[segment]->period()));
+    updateSegment(segment, getPeriod(segment), getPos(segment), segment > 0 ? getPos(segment - 1) : 0);
+  }
+
+  void Envelope::updateSegment(int segment, double period, double target_amp, double prev_target_amp)
+  {
+    EnvelopeSegment& seg = *m_segments[segment];
+    if (period != seg.last_period || m_fsIsDirty) {
+      seg.step = 1. / (m_Fs*period);
+      seg.last_period = period;
     }
     if (m_phase == 0) {
       if (segment == 0)
       {
-        m_segments[segment]->prev_amp = m_initPoint;
+        seg.prev_amp = m_initPoint;
       }
       else if (segment == m_numSegments - 1)
       {
-        m_segments[segment]->prev_amp = getLastOutput();
+        seg.prev_amp = m_amp;
       }
       else
       {
-        m_segments[segment]->prev_amp = getPos(segment - 1);
+        seg.prev_amp = prev_target_amp;
       }
     }
-    m_segments[segment]->is_increasing = m_segments[segment]->target_amp() > m_segments[segment]->prev_amp;
+    seg.is_increasing = target_amp > seg.prev_amp;
   }
 
-  void Envelope::process(int bufind)
+  void Envelope::processBlock(const ParamBlock& params, Sample* out, size_t n)
   {
-    updateSegment(m_currSegment);
-    EnvelopeSegment& currseg = *m_segments[m_currSegment];
-    bool hasHitSetpoint = (currseg.is_increasing && getLastOutput() >= currseg.target_amp()) || \
-      (!currseg.is_increasing && getLastOutput() <= currseg.target_amp());
-    // Advance to a new segment if our time is up or if we're released and we have fully decayed
-    if (m_phase >= 1 || (m_currSegment == m_numSegments - 1 && hasHitSetpoint))
+    const Sample* loopstart = params[m_loopStart];
+    const Sample* loopend = params[m_loopEnd];
+    for (int i = 0; i < n; i++)
     {
-      if (m_currSegment + 1 == int(readParam(1)))
-      { // check if we have reached a loop point
-        setSegment(int(readParam(0)));
-        m_isSynced = true;
-      }
-      else if (m_currSegment < m_numSegments - 2)
-      { // check if we have reached the sustain point
-        setSegment(m_currSegment + 1);
+      EnvelopeSegment* currseg = m_segments[m_currSegment];
+      double target_amp = params[currseg->target_amp()][i];
+      double prev_target_amp = m_currSegment > 0 ? params[m_segments[m_currSegment - 1]->target_amp()][i] : 0;
+      updateSegment(m_currSegment, params[currseg->period()][i], target_amp, prev_target_amp);
+      bool hasHitSetpoint = (currseg->is_increasing && m_amp >= target_amp) || \
+        (!currseg->is_increasing && m_amp <= target_amp);
+      // Advance to a new segment if our time is up or if we're released and we have fully decayed
+      if (m_phase >= 1 || (m_currSegment == m_numSegments - 1 && hasHitSetpoint))
+      {
+        if (m_currSegment + 1 == int(loopend[i]))
+        { // check if we have reached a loop point
+          setSegment(int(loopstart[i]));
+          m_isSynced = true;
+        }
+        else if (m_currSegment < m_numSegments - 2)
+        { // check if we have reached the sustain point
+          setSegment(m_currSegment + 1);
+        }
+        else if (m_currSegment == m_numSegments - 1)
+        { // check if we have fully decayed
+          m_isDone = true;
+          m_isSynced = true;
+        }
       }
-      else if (m_currSegment == m_numSegments - 1)
-      { // check if we have fully decayed
-        m_isDone = true;
-        m_isSynced = true;
+      else
+      {
+        m_phase += currseg->step;
       }
+      currseg = m_segments[m_currSegment];
+      m_amp = LERP(currseg->prev_amp, params[currseg->target_amp()][i], std::pow(m_phase, params[currseg->shape()][i]));
+      out[i] = m_amp;
     }
-    else
-    {
-      m_phase += m_segments[m_currSegment]->step;
-    }
-    const EnvelopeSegment& currSeg = *m_segments[m_currSegment];
-    m_output[bufind] = LERP(currSeg.prev_amp, currSeg.target_amp(), std::pow(m_phase, currSeg.shape()));
   }
 
   void Envelope::setSegment(int seg)
@@ -136,6 +154,22 @@ namespace syn
     m_phase = 0.0;
   }
 
+  void Envelope::copyStateImpl(const Unit& other)
+  {
+    const Envelope& env = static_cast<const Envelope&>(other);
+    if (env.m_numSegments != m_numSegments)
+      return;
+    m_currSegment = env.m_currSegment;
+    m_isDone = env.m_isDone;
+    m_RelPoint = env.m_RelPoint;
+    m_phase = env.m_phase;
+    m_amp = env.m_amp;
+    for (int i = 0; i < m_numSegments; i++)
+    {
+      m_segments[i]->prev_amp = env.m_segments[i]->prev_amp;
+    }
+  }
+
   void Envelope::noteOn(int pitch, int vel)
   {
     setSegment(0);
@@ -10,7 +10,7 @@ namespace syn
 {
   class Envelope;
 
-  class EnvelopeSegment
+  class EnvelopeSegment : public ArenaAllocated
   {
   protected:
     Envelope* m_parent;
@@ -19,22 +19,23 @@ namespace syn
     int m_shape_id;
   public:
 
-    EnvelopeSegment::EnvelopeSegment(Envelope* parent, int pid, int taid, int sid) :
+    EnvelopeSegment(Envelope* parent, int pid, int taid, int sid) :
       m_parent(parent),
       m_period_id(pid),
       m_target_amp_id(taid),
       m_shape_id(sid),
       prev_amp(0),
       step(0),
+      last_period(0),
       is_increasing(false)
     {
     };
 
-    EnvelopeSegment::EnvelopeSegment() : EnvelopeSegment(nullptr, 0, 0, 0)
+    EnvelopeSegment() : EnvelopeSegment(nullptr, 0, 0, 0)
     {
     };
 
-    EnvelopeSegment::EnvelopeSegment(const EnvelopeSegment& other) :
+    EnvelopeSegment(const EnvelopeSegment& other) :
       EnvelopeSegment(other.m_parent, other.m_period_id, other.m_target_amp_id, other.m_shape_id)
     {
     };
@@ -45,6 +46,7 @@ namespace syn
     UnitParameter& shape() const;
     double prev_amp;
     double step;
+    double last_period; //!< period that step was last computed for
     bool is_increasing;
   };
 
@@ -133,8 +135,9 @@ namespace syn
 
   protected:
     void updateSegment(const int segment); //!< Updates the EnvelopeSegment to reflect the values in m_params
+    void updateSegment(const int segment, double period, double target_amp, double prev_target_amp);
 
-    virtual void process(int bufind) override;
+    virtual void processBlock(const ParamBlock& params, Sample* out, size_t n) override;
     void setSegment(int seg);
   private:
     virtual Unit* cloneImpl() const override
@@ -147,6 +150,8 @@ namespace syn
       return "Envelope";
     }
 
+    virtual void copyStateImpl(const Unit& other) override;
+
     vector<EnvelopeSegment*> m_segments;
     UnitParameter& m_loopStart;
     UnitParameter& m_loopEnd;
@@ -156,6 +161,7 @@ namespace syn
     bool m_isDone;
     double m_RelPoint;
     double m_phase;
+    double m_amp; //!< most recent output sample
     bool m_fsIsDirty;
   };
 }
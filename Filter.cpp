@@ -1,4 +1,247 @@
 #include "Filter.h"
+#include "DSPMath.h"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
 namespace syn
 {
-}
\ No newline at end of file
+  namespace
+  {
+    double besselI0(double x)
+    {
+      double sum = 1.0, term = 1.0;
+      for (int k = 1; k < 50 && term > 1e-12 * sum; k++)
+      {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+      }
+      return sum;
+    }
+  }
+
+  HalfBandDecimator::HalfBandDecimator(int numTaps, double beta) :
+    m_coefs(numTaps)
+  {
+    const double pi = 3.14159265358979323846;
+    int center = 2 * numTaps - 1;
+    double sum = 0.5;
+    for (int k = 0; k < numTaps; k++)
+    {
+      int d = 2 * k + 1;
+      double r = double(d) / center;
+      double window = besselI0(beta * sqrt(1 - r * r)) / besselI0(beta);
+      m_coefs[k] = sin(pi * d / 2) / (pi * d) * window;
+      sum += 2 * m_coefs[k];
+    }
+    // normalize the gain at DC, to which the center tap contributes 0.5
+    for (int k = 0; k < numTaps; k++)
+    {
+      m_coefs[k] *= 1.0 / sum;
+    }
+    m_center = 0.5 / sum;
+    resize(0);
+  }
+
+  void HalfBandDecimator::resize(size_t maxInputSize)
+  {
+    m_buffer.resize(getLatency() * 2 + maxInputSize, 0.0);
+  }
+
+  void HalfBandDecimator::reset()
+  {
+    std::fill(m_buffer.begin(), m_buffer.end(), 0.0);
+  }
+
+  void HalfBandDecimator::process(const Sample* in, Sample* out, size_t n)
+  {
+    const int numTaps = m_coefs.size();
+    const int history = 2 * getLatency();
+    const double* coefs = &m_coefs[0];
+    Sample* buffer = &m_buffer[0];
+    std::copy(in, in + n, buffer + history);
+    for (int m = 0; m < n / 2; m++)
+    {
+      // the center of the filter for output m, which is aligned with input sample 2m+1
+      const Sample* x = buffer + history + 2 * m + 1 - getLatency();
+      double y = m_center * x[0];
+      for (int k = 0; k < numTaps; k++)
+      {
+        y += coefs[k] * (x[-(2 * k + 1)] + x[2 * k + 1]);
+      }
+      out[m] = y;
+    }
+    std::copy(buffer + n, buffer + n + history, buffer);
+  }
+
+  BiquadCoefs BiquadCoefs::design(FILTER_MODE mode, double freq, double q)
+  {
+    const double pi = 3.14159265358979323846;
+    freq = std::min(std::max(freq, 1e-5), 0.49);
+    double w0 = 2 * pi * freq;
+    double cosw0 = cos(w0);
+    double alpha = sin(w0) / (2 * q);
+    double b0, b1, b2;
+    switch (mode)
+    {
+    case HIGHPASS_FILTER:
+      b0 = (1 + cosw0) / 2;
+      b1 = -(1 + cosw0);
+      b2 = b0;
+      break;
+    case BANDPASS_FILTER:
+      b0 = alpha;
+      b1 = 0;
+      b2 = -alpha;
+      break;
+    case NOTCH_FILTER:
+      b0 = 1;
+      b1 = -2 * cosw0;
+      b2 = 1;
+      break;
+    case LOWPASS_FILTER:
+    default:
+      b0 = (1 - cosw0) / 2;
+      b1 = 1 - cosw0;
+      b2 = b0;
+      break;
+    }
+    // normalize once here rather than dividing by a0 for every sample
+    double norm = 1.0 / (1 + alpha);
+    return{ b0 * norm, b1 * norm, b2 * norm, -2 * cosw0 * norm, (1 - alpha) * norm };
+  }
+
+  SOSFilter::SOSFilter(int numSections) :
+    m_numSections(numSections)
+  {
+    for (int s = 0; s < MAX_FILTER_SECTIONS; s++)
+    {
+      m_coefs[s] = { 1, 0, 0, 0, 0 };
+    }
+    reset();
+  }
+
+  void SOSFilter::setNumSections(int numSections)
+  {
+    numSections = std::min(std::max(numSections, 1), MAX_FILTER_SECTIONS);
+    for (int s = m_numSections; s < numSections; s++)
+    {
+      m_z1[s] = m_z2[s] = 0;
+    }
+    m_numSections = numSections;
+  }
+
+  void SOSFilter::reset()
+  {
+    std::fill(m_z1, m_z1 + MAX_FILTER_SECTIONS, 0.0);
+    std::fill(m_z2, m_z2 + MAX_FILTER_SECTIONS, 0.0);
+  }
+
+  bool SOSFilter::isClear() const
+  {
+    for (int s = 0; s < m_numSections; s++)
+    {
+      if (m_z1[s] != 0 || m_z2[s] != 0)
+        return false;
+    }
+    return true;
+  }
+
+  void SOSFilter::process(const Sample* in, Sample* out, size_t n)
+  {
+    if (in != out)
+    {
+      std::copy(in, in + n, out);
+    }
+    // run each section over the whole block in turn, keeping its coefficients and state in registers
+    for (int s = 0; s < m_numSections; s++)
+    {
+      const double b0 = m_coefs[s].b0, b1 = m_coefs[s].b1, b2 = m_coefs[s].b2;
+      const double a1 = m_coefs[s].a1, a2 = m_coefs[s].a2;
+      double z1 = m_z1[s], z2 = m_z2[s];
+      for (int i = 0; i < n; i++)
+      {
+        double x = out[i];
+        double y = b0 * x + z1;
+        z1 = b1 * x - a1 * y + z2;
+        z2 = b2 * x - a2 * y;
+        out[i] = y;
+      }
+      m_z1[s] = z1;
+      m_z2[s] = z2;
+    }
+  }
+
+  void SOSFilter::flushDenormals()
+  {
+    for (int s = 0; s < m_numSections; s++)
+    {
+      if (fabs(m_z1[s]) < 1e-20)
+        m_z1[s] = 0;
+      if (fabs(m_z2[s]) < 1e-20)
+        m_z2[s] = 0;
+    }
+  }
+
+  void Filter::setFs(double fs)
+  {
+    Unit::setFs(fs);
+    invalidateCoefs();
+  }
+
+  void Filter::invalidateCoefs()
+  {
+    m_coefsMode = -1;
+    m_coefsCutoff = m_coefsResonance = std::numeric_limits<double>::quiet_NaN();
+  }
+
+  void Filter::copyStateImpl(const Unit& other)
+  {
+    const Filter& filter = static_cast<const Filter&>(other);
+    m_filter = filter.m_filter;
+    m_coefsMode = filter.m_coefsMode;
+    m_coefsCutoff = filter.m_coefsCutoff;
+    m_coefsResonance = filter.m_coefsResonance;
+  }
+
+  void Filter::computeCoefs(int mode, double cutoff, double resonance)
+  {
+    BiquadCoefs coefs = BiquadCoefs::design(FILTER_MODE(mode), pitchToFreq(cutoff) / m_Fs, resonance);
+    for (int s = 0; s < MAX_FILTER_SECTIONS; s++)
+    {
+      m_filter.setCoefs(s, coefs);
+    }
+    m_coefsMode = mode;
+    m_coefsCutoff = cutoff;
+    m_coefsResonance = resonance;
+  }
+
+  void Filter::processBlock(const ParamBlock& params, Sample* out, size_t n)
+  {
+    const Sample* input = params[m_input];
+    const Sample* cutoff = params[m_cutoff];
+    const Sample* resonance = params[m_resonance];
+    const int mode = params[m_mode][0];
+    m_filter.setNumSections(params[m_sections][0]);
+    if (params.isConstant(m_input) && input[0] == 0 && m_filter.isClear())
+    {
+      // silence in, silence out
+      std::fill(out, out + n, 0.0);
+      return;
+    }
+    if (params.isConstant(m_cutoff) && params.isConstant(m_resonance))
+    {
+      updateCoefs(mode, cutoff[0], resonance[0]);
+      m_filter.process(input, out, n);
+    }
+    else
+    {
+      for (int i = 0; i < n; i++)
+      {
+        updateCoefs(mode, cutoff[i], resonance[i]);
+        out[i] = m_filter.process(input[i]);
+      }
+    }
+    m_filter.flushDenormals();
+  }
+}
@@ -1,79 +1,193 @@
 #ifndef __FILTER__
 #define __FILTER__
 #include "Unit.h"
-#include <cstring>
-#include <cstdlib>
-#define AA_FILTER_SIZE 9
-const double AA_FILTER_X[AA_FILTER_SIZE] = { 0.13690162, 1.09521296, 3.83324538, 7.66649075, 9.58311344, 7.66649075, 3.83324538, 1.09521296, 0.13690162 };
-const double AA_FILTER_Y[AA_FILTER_SIZE] = { 1., 4.12597592, 8.10936447, 9.53668245, 7.30172852, 3.69021981, 1.21561014, 0.24170958, 0.02785143 };
+#include <vector>
+
+#define MAX_FILTER_SECTIONS 4 //!< maximum number of second-order sections cascaded by a SOSFilter
+
+#define HALFBAND_TAPS 16 //!< nonzero taps on each side of the center of the sharpest half-band filter
+#define HALFBAND_SHORT_TAPS 6 //!< same, for the wider transition band of the first stages of a decimation chain
 
 using namespace std;
 namespace syn
 {
-  template <size_t nX, size_t nY>
-  class Filter : public Unit
+  /**
+   * \class HalfBandDecimator
+   *
+   * \brief Halves the sample rate of a signal with a linear phase, Kaiser windowed half-band FIR low-pass.
+   *
+   * Every other tap of a half-band filter is zero, and only every other output is kept, so the filter is evaluated
+   * in polyphase form: each output costs one multiplication per nonzero tap pair, plus one for the center tap.
+   * Chaining several decimators divides the rate by any power of two. Since the content between the final band
+   * and the next stage's band is filtered by the later stages, all but the last stage of a chain can use a wider
+   * transition band, and therefore fewer taps.
+   */
+  class HalfBandDecimator
   {
-  protected:
-    const double(&XCoefs)[nX];
-    const double(&YCoefs)[nY];
-    double *YBuf, *XBuf;
-    int xBufInd, yBufInd;
-    UnitParameter& m_input;
   public:
-    Filter(string name, const double(&X)[nX], const double(&Y)[nY]) :
-      Unit(name),
-      XCoefs(X),
-      YCoefs(Y),
-      m_input(addParam("input", DOUBLE_TYPE, -1, 1, true))
-    {
-      XBuf = (double*)malloc(sizeof(double)*nX);
-      YBuf = (double*)malloc(sizeof(double)*nY);
-      reset();
-    };
-    Filter(const Filter& filt);
-    ~Filter()
-    {
-      delete[] YBuf;
-      delete[] XBuf;
-    };
-    void reset() { memset(YBuf, 0, nY*sizeof(double)); memset(XBuf, 0, nX*sizeof(double)); xBufInd = 0; yBufInd = 0; };
-  protected:
-    virtual void process(int bufind);
+    /**
+     * \param numTaps Number of nonzero taps on either side of the center tap; the filter is 4*numTaps-1 long.
+     * \param beta Kaiser window shape, trading transition width for stop band attenuation.
+     */
+    HalfBandDecimator(int numTaps = HALFBAND_TAPS, double beta = 9.0);
+    /**
+     * \brief Prepares the decimator for inputs of up to maxInputSize samples. The history is kept.
+     */
+    void resize(size_t maxInputSize);
+    /**
+     * \brief Clears the filter's history.
+     */
+    void reset();
+    /**
+     * \brief Filters the n input samples and writes the n/2 decimated samples to out, where n is even. out may
+     * point to in.
+     */
+    void process(const Sample* in, Sample* out, size_t n);
+    /**
+     * \brief Delay introduced by the filter, in input samples.
+     */
+    int getLatency() const { return 2 * int(m_coefs.size()) - 1; }
   private:
-    virtual Unit* cloneImpl() const { return new Filter(*this); };
+    vector<double> m_coefs; //!< taps at odd distances 1, 3, 5... from the center
+    double m_center; //!< the center tap
+    vector<Sample> m_buffer; //!< the input history followed by the block being processed
+  };
+
+  enum FILTER_MODE
+  {
+    LOWPASS_FILTER = 0,
+    HIGHPASS_FILTER,
+    BANDPASS_FILTER,
+    NOTCH_FILTER,
+    NUM_FILTER_MODES
   };
 
-  template <size_t nX, size_t nY>
-  Filter<nX, nY>::Filter(const Filter<nX, nY>& filt) :
-    Filter<nX, nY>(filt.m_name, filt.XCoefs, filt.YCoefs)
-  {}
+  const vector<string> FILTER_MODE_NAMES{"Lowpass","Highpass","Bandpass","Notch"};
+
+  /**
+   * \brief Coefficients of a second-order section, normalized so that the leading denominator coefficient is 1.
+   */
+  struct BiquadCoefs
+  {
+    double b0, b1, b2; //!< numerator
+    double a1, a2; //!< denominator
+    /**
+     * \brief Designs a resonant section with the bilinear transform (RBJ audio EQ cookbook).
+     * \param freq Cutoff or center frequency, as a fraction of the sample rate. Clamped below Nyquist.
+     * \param q Quality factor; 1/sqrt(2) gives a Butterworth low-pass or high-pass.
+     */
+    static BiquadCoefs design(FILTER_MODE mode, double freq, double q);
+  };
 
-  template <size_t nX, size_t nY>
-  void Filter<nX, nY>::process(int bufind)
+  /**
+   * \class SOSFilter
+   *
+   * \brief A cascade of up to MAX_FILTER_SECTIONS second-order sections, each in transposed direct form II.
+   *
+   * The transposed form keeps only two state variables per section and behaves well when its coefficients change
+   * between samples, which lets the coefficients follow modulation.
+   */
+  class SOSFilter
   {
-    XBuf[xBufInd] = readParam(0);
-    YBuf[yBufInd] = 0.0;
-    double *output = &YBuf[yBufInd];
-    int i, j;
-    for (i = 0, j = xBufInd; i < nX; i++, j--)
+  public:
+    SOSFilter(int numSections = 1);
+    /**
+     * \brief Changes the number of cascaded sections. Sections that are added start with a cleared state.
+     */
+    void setNumSections(int numSections);
+    int getNumSections() const { return m_numSections; }
+    void setCoefs(int section, const BiquadCoefs& coefs) { m_coefs[section] = coefs; }
+    const BiquadCoefs& getCoefs(int section) const { return m_coefs[section]; }
+    /**
+     * \brief Clears the state of every section.
+     */
+    void reset();
+    /**
+     * \brief Returns true if every section's state is zero, i.e. the filter outputs zero for a zero input.
+     */
+    bool isClear() const;
+    /**
+     * \brief Filters n samples with the current coefficients. in and out may point to the same buffer.
+     */
+    void process(const Sample* in, Sample* out, size_t n);
+    /**
+     * \brief Filters a single sample.
+     */
+    double process(double x)
     {
-      if (j < 0)
-        j = nX - 1;
-      YBuf[yBufInd] += XBuf[j] * XCoefs[i];
+      for (int s = 0; s < m_numSections; s++)
+      {
+        const BiquadCoefs& c = m_coefs[s];
+        double y = c.b0 * x + m_z1[s];
+        m_z1[s] = c.b1 * x - c.a1 * y + m_z2[s];
+        m_z2[s] = c.b2 * x - c.a2 * y;
+        x = y;
+      }
+      return x;
     }
-    for (i = 1, j = yBufInd - 1; i < nY; i++, j--)
+    /**
+     * \brief Zeroes state values too small to matter, so that a decaying tail does not end up in denormals.
+     */
+    void flushDenormals();
+  private:
+    int m_numSections;
+    BiquadCoefs m_coefs[MAX_FILTER_SECTIONS];
+    double m_z1[MAX_FILTER_SECTIONS], m_z2[MAX_FILTER_SECTIONS];
+  };
+
+  /**
+   * \class Filter
+   *
+   * \brief Resonant low-pass, high-pass, band-pass or notch filter, with 12 dB/octave per section.
+   *
+   * The cutoff is given as a pitch, so adding the note's pitch to it tracks the keyboard. Coefficients are only
+   * recomputed when the cutoff, resonance or mode differ from the ones they were last computed for: once per block
+   * at most while these are constant, and for every sample at which they change otherwise. The mode and the number
+   * of sections are read at the start of each block.
+   */
+  class Filter : public Unit
+  {
+  public:
+    Filter(string name) : Unit(name),
+      m_input(addParam("input", DOUBLE_TYPE, -1, 1, 0.0, true)),
+      m_mode(addEnumParam("mode", FILTER_MODE_NAMES)),
+      m_cutoff(addParam("cutoff", DOUBLE_TYPE, 0, 128, 100)),
+      m_resonance(addParam("resonance", DOUBLE_TYPE, 0.5, 20, 0.707)),
+      m_sections(addParam("sections", INT_TYPE, 1, MAX_FILTER_SECTIONS, 2))
     {
-      if (j < 0)
-        j = nY - 1;
-      YBuf[yBufInd] -= YBuf[j] * YCoefs[i] / YCoefs[0];
+      invalidateCoefs();
     }
-    xBufInd++;
-    if (xBufInd == nX)
-      xBufInd = 0;
-    yBufInd++;
-    if (yBufInd == nY)
-      yBufInd = 0;
-    m_output[bufind] = *output;
-  }
+    Filter(const Filter& other) : Filter(other.m_name)
+    {}
+    virtual ~Filter() {};
+    virtual void setFs(double fs) override;
+    UnitParameter& m_input;
+    UnitParameter& m_mode;
+    UnitParameter& m_cutoff;
+    UnitParameter& m_resonance;
+    UnitParameter& m_sections;
+  protected:
+    virtual void processBlock(const ParamBlock& params, Sample* out, size_t n) override;
+  private:
+    SOSFilter m_filter;
+    int m_coefsMode; //!< mode the current coefficients were computed for
+    double m_coefsCutoff; //!< cutoff the current coefficients were computed for
+    double m_coefsResonance; //!< resonance the current coefficients were computed for
+    void invalidateCoefs();
+    virtual void copyStateImpl(const Unit& other) override;
+    /**
+     * \brief Recomputes the coefficients of every section, unless they were computed for the same values.
+     */
+    void updateCoefs(int mode, double cutoff, double resonance)
+    {
+      if (cutoff != m_coefsCutoff || resonance != m_coefsResonance || mode != m_coefsMode)
+      {
+        computeCoefs(mode, cutoff, resonance);
+      }
+    }
+    void computeCoefs(int mode, double cutoff, double resonance);
+    virtual Unit* cloneImpl() const override { return new Filter(*this); };
+    virtual string getClassName() const override { return "Filter"; };
+  };
 }
-#endif
\ No newline at end of file
+#endif
@@ -1,6 +1,7 @@
 #include "Instrument.h"
 #include "SourceUnit.h"
 #include <cassert>
+#include <algorithm>
 
 namespace syn
 {
@@ -16,6 +17,7 @@ namespace syn
       m_sourcemap.push_back(uid);
       if (m_primarySrcVec.empty())
         m_primarySrcVec.push_back(m_sourcemap.back());
+      m_isGraphDirty = true;
     }
     return uid;
   }
@@ -24,12 +26,14 @@ namespace syn
   {
     assert(std::find(m_sourcemap.begin(), m_sourcemap.end(), srcid) != m_sourcemap.end());
     m_primarySrcVec.push_back(srcid);
+    m_isGraphDirty = true;
   }
 
   void Instrument::resetPrimarySource(int srcid)
   {
     m_primarySrcVec.clear();
     m_primarySrcVec.push_back(srcid);
+    m_isGraphDirty = true;
   }
 
   bool Instrument::isPrimarySource(int srcid) const
@@ -53,30 +57,74 @@ namespace syn
   {
     SourceVec::iterator it = find(m_primarySrcVec.begin(), m_primarySrcVec.end(), srcid);
     if (it != m_primarySrcVec.end()) m_primarySrcVec.erase(it);
+    m_isGraphDirty = true;
+  }
+
+  void Instrument::compile()
+  {
+    Circuit::compile();
+    m_sources.clear();
+    for (int i = 0; i < m_sourcemap.size(); i++)
+    {
+      m_sources.push_back(static_cast<SourceUnit*>(m_units.at(m_sourcemap[i])));
+    }
+    m_primarySources.clear();
+    for (int i = 0; i < m_primarySrcVec.size(); i++)
+    {
+      m_primarySources.push_back(static_cast<SourceUnit*>(m_units.at(m_primarySrcVec[i])));
+    }
   }
 
   void Instrument::noteOn(int pitch, int vel)
   {
+    if (m_isGraphDirty)
+    {
+      compile();
+    }
     m_note = pitch;
-    for (int i = 0; i < m_sourcemap.size(); i++)
+    for (int i = 0; i < m_sources.size(); i++)
     {
-      static_cast<SourceUnit*>(m_units[m_sourcemap[i]])->noteOn(pitch, vel);
+      m_sources[i]->noteOn(pitch, vel);
     }
   }
 
   void Instrument::noteOff(int pitch, int vel)
   {
-    for (int i = 0; i < m_sourcemap.size(); i++)
+    if (m_isGraphDirty)
     {
-      static_cast<SourceUnit*>(m_units[m_sourcemap[i]])->noteOff(pitch, vel);
+      compile();
+    }
+    for (int i = 0; i < m_sources.size(); i++)
+    {
+      m_sources[i]->noteOff(pitch, vel);
+    }
+  }
+
+  void Instrument::setMidiControl(MIDI_CONTROL control, int num, double value)
+  {
+    if (m_isGraphDirty)
+    {
+      compile();
+    }
+    for (int i = 0; i < m_sources.size(); i++)
+    {
+      m_sources[i]->onMidiControl(control, num, value);
     }
   }
 
   bool Instrument::isActive() const
   {
     if (m_sinkId < 0) return false;
-    for (int i = 0; i < m_primarySrcVec.size(); i++) {
-      if (static_cast<SourceUnit*>(m_units.at(m_primarySrcVec[i]))->isActive()) return true;
+    if (m_isGraphDirty)
+    {
+      // the schedule is stale, so read the sources from the graph
+      for (int i = 0; i < m_primarySrcVec.size(); i++) {
+        if (static_cast<SourceUnit*>(m_units.at(m_primarySrcVec[i]))->isActive()) return true;
+      }
+      return false;
+    }
+    for (int i = 0; i < m_primarySources.size(); i++) {
+      if (m_primarySources[i]->isActive()) return true;
     }
     return false;
   }
@@ -1,21 +1,22 @@
 #pragma once
 #include "Circuit.h"
+#include "SourceUnit.h"
 #include <unordered_map>
+#include <algorithm>
 
 using std::unordered_map;
 namespace syn
 {
-  class SourceUnit;
-
   class Instrument :
     public Circuit
   {
   public:
-    Instrument() : m_note(-1) {};
+    Instrument() : m_note(-1), m_oversampling(1) {};
     Instrument(const Instrument& instr) :
       m_sourcemap(instr.m_sourcemap),
       m_note(instr.m_note),
-      m_primarySrcVec(instr.m_primarySrcVec)
+      m_primarySrcVec(instr.m_primarySrcVec),
+      m_oversampling(instr.m_oversampling)
     {}
     virtual ~Instrument() {};
 
@@ -37,13 +38,29 @@ namespace syn
     bool isSourceUnit(int srcid) const { return find(m_sourcemap.begin(), m_sourcemap.end(), srcid) != m_sourcemap.end(); };
     void noteOn(int note, int vel);
     void noteOff(int note, int vel);
+    /**
+     * \brief Forwards a change of one of the voice's MIDI controllers to the source units.
+     * \sa SourceUnit::onMidiControl
+     */
+    void setMidiControl(MIDI_CONTROL control, int num, double value);
     bool isActive() const;
     int getNote() const { return m_note; }
+    /**
+     * \brief Sets the factor (1, 2, 4 or 8) by which the sample rate of the instrument's voices exceeds the output
+     * rate. Only stored here, so that it is saved with the patch; the VoiceManager applies it.
+     * \sa VoiceManager::setOversampling
+     */
+    void setOversampling(int factor) { m_oversampling = factor; }
+    int getOversampling() const { return m_oversampling; }
   protected:
     typedef vector<int> SourceVec;
     SourceVec m_sourcemap;
     int m_note;
     SourceVec m_primarySrcVec;
+    int m_oversampling;
+    vector<SourceUnit*> m_sources; //!< compiled from m_sourcemap
+    vector<SourceUnit*> m_primarySources; //!< compiled from m_primarySrcVec
+    virtual void compile() override;
   private:
     virtual Circuit* cloneImpl() const override;
   };
@@ -3,44 +3,67 @@
 void MIDIReceiver::onMessageReceived(IMidiMsg* midiMessage)
 {
   IMidiMsg::EStatusMsg status = midiMessage->StatusMsg();
-  // We're only interested in Note On/Off messages (not CC, pitch, etc.)
-  if (status == IMidiMsg::kControlChange || status == IMidiMsg::kNoteOn || status == IMidiMsg::kNoteOff)
+  switch (status)
+  {
+  case IMidiMsg::kNoteOn:
+  case IMidiMsg::kNoteOff:
+  case IMidiMsg::kControlChange:
+  case IMidiMsg::kPitchWheel:
+  case IMidiMsg::kChannelAftertouch:
+  case IMidiMsg::kPolyAftertouch:
     mMidiQueue.Add(midiMessage);
+    break;
+  default:
+    break;
+  }
 }
 
-void MIDIReceiver::advance()
+void MIDIReceiver::advance(int offset)
 {
+  mOffset = offset;
   while (!mMidiQueue.Empty())
   {
     IMidiMsg* midiMessage = mMidiQueue.Peek();
     if (midiMessage->mOffset > mOffset) break;
 
     IMidiMsg::EStatusMsg status = midiMessage->StatusMsg();
+    int channel = midiMessage->Channel();
     if (status == IMidiMsg::kNoteOff || status == IMidiMsg::kNoteOn)
     {
       int noteNumber = midiMessage->NoteNumber();
       int velocity = midiMessage->Velocity();
       if (status == IMidiMsg::kNoteOn && velocity > 0)
       {
-        if (mKeyStatus[noteNumber] == false)
+        if (mKeyStatus[channel][noteNumber] == false)
         {
-          mKeyStatus[noteNumber] = true;
+          mKeyStatus[channel][noteNumber] = true;
           mNumKeys += 1;
-          noteOn(noteNumber, velocity);
+          noteOn(noteNumber, velocity, channel);
         }
       }
       else
       {
-        mKeyStatus[noteNumber] = false;
+        mKeyStatus[channel][noteNumber] = false;
         mNumKeys -= 1;
-        noteOff(noteNumber, velocity);
+        noteOff(noteNumber, velocity, channel);
       }
     }
     else if (status == IMidiMsg::kControlChange)
     {
-      sendControlChange(*midiMessage);
+      controlChange(midiMessage->mData1, midiMessage->mData2, channel);
+    }
+    else if (status == IMidiMsg::kPitchWheel)
+    {
+      pitchBend(midiMessage->PitchWheel(), channel);
+    }
+    else if (status == IMidiMsg::kChannelAftertouch)
+    {
+      channelPressure(midiMessage->mData1, channel);
+    }
+    else if (status == IMidiMsg::kPolyAftertouch)
+    {
+      polyPressure(midiMessage->mData1, midiMessage->mData2, channel);
     }
     mMidiQueue.Remove();
   }
-  mOffset++;
 }
\ No newline at end of file
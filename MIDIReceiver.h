@@ -4,6 +4,7 @@
 #include "IPlug_include_in_plug_hdr.h"
 #include "IMidiQueue.h"
 #include "GallantSignal.h"
+using Gallant::Signal3;
 using Gallant::Signal2;
 using Gallant::Signal1;
 
@@ -15,27 +16,46 @@ class MIDIReceiver {
 private:
   IMidiQueue mMidiQueue;
   static const int keyCount = 128;
+  static const int channelCount = 16;
   int mNumKeys, mPrevNumKeys; // how many keys are being played at the moment (via midi)
-  bool mKeyStatus[keyCount]; // array of on/off for each key (index is note number)
+  bool mKeyStatus[channelCount][keyCount]; // array of on/off for each key (indices are channel and note number)
   int mOffset;
 
 public:
-  Signal2<uint8_t, uint8_t> noteOn;
-  Signal2<uint8_t, uint8_t> noteOff;
-  Signal1<IMidiMsg&> sendControlChange;
+  // the last argument of each signal is the MIDI channel
+  Signal3<uint8_t, uint8_t, uint8_t> noteOn;
+  Signal3<uint8_t, uint8_t, uint8_t> noteOff;
+  Signal3<uint8_t, uint8_t, uint8_t> controlChange; //!< controller number and value
+  Signal2<double, uint8_t> pitchBend; //!< normalized to [-1,1]
+  Signal2<uint8_t, uint8_t> channelPressure;
+  Signal3<uint8_t, uint8_t, uint8_t> polyPressure; //!< note number and pressure
   MIDIReceiver() :
     mNumKeys(0),
     mOffset(0) {
-    for (int i = 0; i < keyCount; i++) {
-      mKeyStatus[i] = false;
+    for (int c = 0; c < channelCount; c++) {
+      for (int i = 0; i < keyCount; i++) {
+        mKeyStatus[c][i] = false;
+      }
     }
   };
 
-  // Returns true if the key with a given index is currently pressed
-  inline bool getKeyStatus(int keyIndex) const { return mKeyStatus[keyIndex]; }
+  // Returns true if the key with a given index is currently pressed on any channel
+  inline bool getKeyStatus(int keyIndex) const {
+    for (int c = 0; c < channelCount; c++) {
+      if (mKeyStatus[c][keyIndex]) return true;
+    }
+    return false;
+  }
   // Returns the number of keys currently pressed
   inline int getNumKeys() const { return mNumKeys; }
-  void advance();
+  /**
+   * \brief Dispatches every queued message due at or before the given sample of the block.
+   */
+  void advance(int offset);
+  /**
+   * \brief Returns the sample at which the next queued message is due, or -1 if the queue is empty.
+   */
+  inline int getNextOffset() const { return mMidiQueue.Empty() ? -1 : mMidiQueue.Peek()->mOffset; }
   void onMessageReceived(IMidiMsg* midiMessage);
   inline void Flush(int nFrames) { mMidiQueue.Flush(nFrames); mOffset = 0; }
   inline void Resize(int blockSize) { mMidiQueue.Resize(blockSize); }
@@ -0,0 +1,57 @@
+#include "MidiControl.h"
+
+namespace syn
+{
+  void MidiControlUnit::onMidiControl(MIDI_CONTROL control, int num, double value)
+  {
+    switch (control)
+    {
+    case PITCH_BEND:
+      m_pitchBend = value;
+      break;
+    case CHANNEL_PRESSURE:
+      m_pressure = value;
+      break;
+    case POLY_PRESSURE:
+      m_polyPressure = value;
+      break;
+    case CONTROL_CHANGE:
+      if (num >= 0 && num < NUM_MIDI_CCS)
+        m_controls[num] = value;
+      break;
+    default:
+      break;
+    }
+  }
+
+  double MidiControlUnit::getValue(int source, int cc) const
+  {
+    switch (source)
+    {
+    case SRC_PITCH_BEND:
+      return m_pitchBend;
+    case SRC_MOD_WHEEL:
+      return m_controls[MIDI_CC_MOD_WHEEL];
+    case SRC_PRESSURE:
+      return m_pressure;
+    case SRC_POLY_PRESSURE:
+      return m_polyPressure;
+    case SRC_SUSTAIN:
+      return m_controls[MIDI_CC_SUSTAIN];
+    case SRC_CC:
+      return cc >= 0 && cc < NUM_MIDI_CCS ? m_controls[cc] : 0;
+    default:
+      return 0;
+    }
+  }
+
+  void MidiControlUnit::processBlock(const ParamBlock& params, Sample* out, size_t n)
+  {
+    double value = getValue(int(params[m_source][0]), int(params[m_cc][0]));
+    const Sample* gain = params[m_gain];
+    for (int i = 0; i < n; i++)
+    {
+      out[i] = value * gain[i];
+    }
+  }
+}
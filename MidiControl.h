@@ -0,0 +1,78 @@
+#ifndef __MIDICONTROL__
+#define __MIDICONTROL__
+#include "SourceUnit.h"
+#include <vector>
+#include <string>
+
+using namespace std;
+
+namespace syn
+{
+  enum MIDI_CONTROL_SOURCE
+  {
+    SRC_PITCH_BEND = 0,
+    SRC_MOD_WHEEL,
+    SRC_PRESSURE,
+    SRC_POLY_PRESSURE,
+    SRC_SUSTAIN,
+    SRC_CC,
+    NUM_MIDI_CONTROL_SOURCES
+  };
+
+  const vector<string> MIDI_CONTROL_SOURCE_NAMES{"Pitch bend","Mod wheel","Pressure","Poly pressure","Sustain","CC"};
+
+  /**
+   * \class MidiControlUnit
+   *
+   * \brief Outputs the value of one of the voice's MIDI controllers, scaled by its gain, so that it can modulate
+   * any parameter.
+   *
+   * The value only changes between (sub-)blocks, so the output is a constant buffer. Pitch bend ranges over [-1,1]
+   * and everything else over [0,1]; with a gain of 2, pitch bend added to an oscillator's pitch bends by two
+   * semitones.
+   */
+  class MidiControlUnit : public SourceUnit
+  {
+  public:
+    MidiControlUnit(string name) : SourceUnit(name),
+      m_source(addEnumParam("source", MIDI_CONTROL_SOURCE_NAMES)),
+      m_cc(addParam("cc", INT_TYPE, 0, NUM_MIDI_CCS - 1, MIDI_CC_MOD_WHEEL)),
+      m_gain(addParam("gain", DOUBLE_TYPE, -24, 24, 1.0)),
+      m_pitchBend(0),
+      m_pressure(0),
+      m_polyPressure(0)
+    {
+      for (int i = 0; i < NUM_MIDI_CCS; i++)
+      {
+        m_controls[i] = 0;
+      }
+    }
+
+    MidiControlUnit(const MidiControlUnit& other) : MidiControlUnit(other.m_name)
+    {}
+
+    virtual void noteOn(int pitch, int vel) override { m_polyPressure = 0; }
+    virtual void noteOff(int pitch, int vel) override {}
+    virtual int getSamplesPerPeriod() const override { return 0; }
+    /**
+     * \brief Controllers never keep a voice alive, so a MidiControlUnit should not be made a primary source.
+     */
+    virtual bool isActive() const override { return false; }
+    virtual void onMidiControl(MIDI_CONTROL control, int num, double value) override;
+  protected:
+    virtual void processBlock(const ParamBlock& params, Sample* out, size_t n) override;
+    virtual bool isStateless() const override { return true; }
+  private:
+    UnitParameter& m_source;
+    UnitParameter& m_cc;
+    UnitParameter& m_gain;
+    double m_pitchBend;
+    double m_pressure;
+    double m_polyPressure;
+    double m_controls[NUM_MIDI_CCS];
+    double getValue(int source, int cc) const;
+    virtual Unit* cloneImpl() const override { return new MidiControlUnit(*this); }
+    virtual string getClassName() const override { return "MidiControlUnit"; }
+  };
+}
+#endif
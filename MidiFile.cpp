@@ -0,0 +1,242 @@
+#include "MidiFile.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace syn
+{
+  namespace
+  {
+    struct TickEvent
+    {
+      uint64_t tick;
+      int order; //!< position in the file, so simultaneous events keep their original order
+      bool isTempo;
+      uint32_t tempo; //!< microseconds per quarter note, for tempo events
+      MidiEvent msg;
+    };
+
+    class MidiReader
+    {
+    public:
+      MidiReader(const unsigned char* data, size_t size) :
+        m_data(data),
+        m_end(data + size)
+      {}
+
+      uint8_t u8()
+      {
+        require(1);
+        return *m_data++;
+      }
+
+      uint32_t be(int nbytes)
+      {
+        require(nbytes);
+        uint32_t value = 0;
+        for (int i = 0; i < nbytes; i++)
+        {
+          value = (value << 8) | *m_data++;
+        }
+        return value;
+      }
+
+      uint32_t varlen()
+      {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++)
+        {
+          uint8_t byte = u8();
+          value = (value << 7) | (byte & 0x7F);
+          if (!(byte & 0x80))
+            return value;
+        }
+        throw std::invalid_argument("Malformed MIDI file: variable length quantity is too long.");
+      }
+
+      void skip(size_t n)
+      {
+        require(n);
+        m_data += n;
+      }
+
+      const unsigned char* pos() const { return m_data; }
+      size_t remaining() const { return m_end - m_data; }
+    private:
+      void require(size_t n) const
+      {
+        if (size_t(m_end - m_data) < n)
+          throw std::invalid_argument("Malformed MIDI file: unexpected end of data.");
+      }
+
+      const unsigned char* m_data;
+      const unsigned char* m_end;
+    };
+
+    int dataBytesOf(uint8_t status)
+    {
+      switch (status & 0xF0)
+      {
+      case 0xC0:
+      case 0xD0:
+        return 1;
+      default:
+        return 2;
+      }
+    }
+
+    void readTrack(MidiReader& track, vector<TickEvent>& events, int& order)
+    {
+      uint64_t tick = 0;
+      uint8_t runningStatus = 0;
+      while (track.remaining() > 0)
+      {
+        tick += track.varlen();
+        uint8_t status = track.u8();
+        if (status == 0xFF)
+        {
+          uint8_t type = track.u8();
+          uint32_t len = track.varlen();
+          if (type == 0x51 && len == 3)
+          {
+            TickEvent ev = {};
+            ev.tick = tick;
+            ev.order = order++;
+            ev.isTempo = true;
+            ev.tempo = track.be(3);
+            events.push_back(ev);
+          }
+          else
+          {
+            track.skip(len);
+          }
+          if (type == 0x2F)
+          {
+            // end of track; keep it so the file's duration includes trailing silence
+            TickEvent ev = {};
+            ev.tick = tick;
+            ev.order = order++;
+            events.push_back(ev);
+            return;
+          }
+          continue;
+        }
+        if (status == 0xF0 || status == 0xF7)
+        {
+          track.skip(track.varlen());
+          continue;
+        }
+
+        uint8_t data1;
+        if (status & 0x80)
+        {
+          runningStatus = status;
+          data1 = track.u8();
+        }
+        else
+        {
+          if (!runningStatus)
+            throw std::invalid_argument("Malformed MIDI file: data byte without a status byte.");
+          data1 = status;
+          status = runningStatus;
+        }
+        uint8_t data2 = dataBytesOf(status) == 2 ? track.u8() : 0;
+
+        TickEvent ev = {};
+        ev.tick = tick;
+        ev.order = order++;
+        ev.msg.status = status;
+        ev.msg.data1 = data1;
+        ev.msg.data2 = data2;
+        events.push_back(ev);
+      }
+    }
+  }
+
+  void MidiFile::load(const char* data, size_t size)
+  {
+    MidiReader reader(reinterpret_cast<const unsigned char*>(data), size);
+    if (reader.be(4) != 0x4D546864) // "MThd"
+      throw std::invalid_argument("Not a MIDI file.");
+    uint32_t headerlen = reader.be(4);
+    if (headerlen < 6)
+      throw std::invalid_argument("Malformed MIDI file: header is too short.");
+    int format = reader.be(2);
+    int ntracks = reader.be(2);
+    uint16_t division = reader.be(2);
+    reader.skip(headerlen - 6);
+    if (format > 1)
+      throw std::invalid_argument("Only format 0 and 1 MIDI files are supported.");
+
+    vector<TickEvent> events;
+    int order = 0;
+    for (int i = 0; i < ntracks && reader.remaining() > 0; i++)
+    {
+      uint32_t chunktype = reader.be(4);
+      uint32_t chunklen = reader.be(4);
+      if (chunklen > reader.remaining())
+        throw std::invalid_argument("Malformed MIDI file: track is truncated.");
+      if (chunktype != 0x4D54726B) // "MTrk"
+      {
+        reader.skip(chunklen);
+        i--;
+        continue;
+      }
+      MidiReader track(reader.pos(), chunklen);
+      readTrack(track, events, order);
+      reader.skip(chunklen);
+    }
+
+    std::sort(events.begin(), events.end(), [](const TickEvent& a, const TickEvent& b)
+              {
+                return a.tick != b.tick ? a.tick < b.tick : a.order < b.order;
+              });
+
+    double secondsPerTick;
+    bool smpte = (division & 0x8000) != 0;
+    if (smpte)
+    {
+      int fps = -int(int8_t(division >> 8));
+      int ticksPerFrame = division & 0xFF;
+      // 29 denotes 30 fps drop-frame
+      secondsPerTick = 1.0 / ((fps == 29 ? 29.97 : fps) * ticksPerFrame);
+    }
+    else
+    {
+      if (division == 0)
+        throw std::invalid_argument("Malformed MIDI file: zero ticks per quarter note.");
+      secondsPerTick = 0.5 / division; // 120 bpm until the first tempo event
+    }
+
+    m_events.clear();
+    uint64_t lasttick = 0;
+    double lasttime = 0.0;
+    for (int i = 0; i < events.size(); i++)
+    {
+      TickEvent& ev = events[i];
+      lasttime += (ev.tick - lasttick) * secondsPerTick;
+      lasttick = ev.tick;
+      if (ev.isTempo)
+      {
+        if (!smpte && ev.tempo > 0)
+          secondsPerTick = ev.tempo * 1e-6 / division;
+      }
+      else if (ev.msg.status)
+      {
+        ev.msg.time = lasttime;
+        m_events.push_back(ev.msg);
+      }
+    }
+    m_duration = lasttime;
+  }
+
+  void MidiFile::loadFile(const string& path)
+  {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+      throw std::invalid_argument("Unable to open MIDI file: " + path);
+    vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    load(data.data(), data.size());
+  }
+}
@@ -0,0 +1,53 @@
+#ifndef __MIDIFILE__
+#define __MIDIFILE__
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace syn
+{
+  /**
+   * \brief A channel message from a MIDI file, timestamped in seconds from the start of the file.
+   */
+  struct MidiEvent
+  {
+    double time;
+    uint8_t status;
+    uint8_t data1;
+    uint8_t data2;
+  };
+
+  /**
+   * \class MidiFile
+   *
+   * \brief Standard MIDI file (format 0 or 1) reader.
+   *
+   * The channel messages of all tracks are merged into a single list sorted by time. Tempo changes are applied when
+   * converting ticks to seconds, and SMPTE time divisions are supported. System exclusive and meta events other than
+   * tempo changes are discarded.
+   */
+  class MidiFile
+  {
+  public:
+    MidiFile() :
+      m_duration(0.0)
+    {}
+    /**
+     * \brief Parses a MIDI file. Throws std::invalid_argument if the data is not a valid MIDI file.
+     */
+    void load(const char* data, size_t size);
+    void loadFile(const string& path);
+    const vector<MidiEvent>& getEvents() const { return m_events; }
+    /**
+     * \brief Time of the last event (including meta events such as end of track), in seconds.
+     */
+    double getDuration() const { return m_duration; }
+  private:
+    vector<MidiEvent> m_events;
+    double m_duration;
+  };
+}
+#endif
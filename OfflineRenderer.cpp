@@ -0,0 +1,171 @@
+#include "OfflineRenderer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+
+namespace syn
+{
+  namespace
+  {
+    void putLE(FILE* file, uint32_t value, int nbytes)
+    {
+      for (int i = 0; i < nbytes; i++)
+      {
+        fputc((value >> (8 * i)) & 0xFF, file);
+      }
+    }
+
+    void writeSamples(FILE* file, const vector<vector<Sample>>& channels)
+    {
+      vector<float> frame(channels.size());
+      for (int i = 0; i < channels[0].size(); i++)
+      {
+        for (int c = 0; c < channels.size(); c++)
+        {
+          frame[c] = float(channels[c][i]);
+        }
+        fwrite(frame.data(), sizeof(float), channels.size(), file);
+      }
+    }
+
+    FILE* openForWriting(const string& path)
+    {
+      FILE* file = fopen(path.c_str(), "wb");
+      if (!file)
+        throw std::invalid_argument("Unable to open output file: " + path);
+      return file;
+    }
+  }
+
+  OfflineRenderer::OfflineRenderer(VoiceManager& vm, double fs, size_t blocksize) :
+    m_vm(vm),
+    m_Fs(fs),
+    m_blockSize(blocksize),
+    m_renderTime(0.0),
+    m_renderedSamples(0)
+  {
+    m_vm.setBufSize(m_blockSize);
+    m_vm.setFs(m_Fs);
+  }
+
+  void OfflineRenderer::render(const vector<MidiEvent>& events, double duration, double tail, vector<vector<Sample>>& out,
+                               int numChannels)
+  {
+    size_t nsamples = size_t((duration + tail) * m_Fs);
+    size_t nblocks = (nsamples + m_blockSize - 1) / m_blockSize;
+    out.resize(numChannels);
+    for (int c = 0; c < numChannels; c++)
+    {
+      out[c].assign(nblocks * m_blockSize, 0.0);
+    }
+    vector<Sample*> bufs(numChannels);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int nextEvent = 0;
+    for (size_t block = 0; block < nblocks; block++)
+    {
+      size_t blockEnd = (block + 1) * m_blockSize;
+      size_t s = block * m_blockSize;
+      while (s < blockEnd)
+      {
+        while (nextEvent < events.size() && size_t(events[nextEvent].time * m_Fs) <= s)
+        {
+          dispatch(events[nextEvent++]);
+        }
+        size_t next = blockEnd;
+        if (nextEvent < events.size())
+          next = std::min(next, size_t(events[nextEvent].time * m_Fs));
+        for (int c = 0; c < numChannels; c++)
+        {
+          bufs[c] = &out[c][s];
+        }
+        m_vm.tick(bufs.data(), numChannels, next - s, s - block * m_blockSize);
+        s = next;
+      }
+    }
+    std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+
+    for (int c = 0; c < numChannels; c++)
+    {
+      out[c].resize(nsamples);
+    }
+    m_renderTime = std::chrono::duration<double>(stop - start).count();
+    m_renderedSamples = nsamples;
+  }
+
+  double OfflineRenderer::getRealtimeMultiple() const
+  {
+    if (m_renderTime <= 0)
+      return 0.0;
+    return m_renderedSamples / m_Fs / m_renderTime;
+  }
+
+  void OfflineRenderer::dispatch(const MidiEvent& event)
+  {
+    uint8_t channel = event.status & 0x0F;
+    switch (event.status & 0xF0)
+    {
+    case 0x90:
+      if (event.data2 > 0)
+      {
+        m_vm.noteOn(event.data1, event.data2, channel);
+        break;
+      }
+      // note on with zero velocity is a note off
+    case 0x80:
+      m_vm.noteOff(event.data1, event.data2, channel);
+      break;
+    case 0xA0:
+      m_vm.polyPressure(event.data1, event.data2, channel);
+      break;
+    case 0xB0:
+      m_vm.controlChange(event.data1, event.data2, channel);
+      break;
+    case 0xD0:
+      m_vm.channelPressure(event.data1, channel);
+      break;
+    case 0xE0:
+      m_vm.pitchBend(((event.data2 << 7 | event.data1) - 8192) / 8192.0, channel);
+      break;
+    default:
+      break;
+    }
+  }
+
+  void OfflineRenderer::writeWav(const string& path, const vector<vector<Sample>>& channels, double fs)
+  {
+    FILE* file = openForWriting(path);
+    int numChannels = channels.size();
+    uint32_t numFrames = channels[0].size();
+    uint32_t datasize = numFrames * numChannels * sizeof(float);
+    fwrite("RIFF", 1, 4, file);
+    putLE(file, 4 + 26 + 12 + 8 + datasize, 4);
+    fwrite("WAVE", 1, 4, file);
+    // fmt chunk, WAVE_FORMAT_IEEE_FLOAT
+    fwrite("fmt ", 1, 4, file);
+    putLE(file, 18, 4);
+    putLE(file, 3, 2);
+    putLE(file, numChannels, 2);
+    putLE(file, uint32_t(fs), 4);
+    putLE(file, uint32_t(fs) * numChannels * sizeof(float), 4);
+    putLE(file, numChannels * sizeof(float), 2);
+    putLE(file, 32, 2);
+    putLE(file, 0, 2);
+    // fact chunk, required for non-PCM formats
+    fwrite("fact", 1, 4, file);
+    putLE(file, 4, 4);
+    putLE(file, numFrames, 4);
+    fwrite("data", 1, 4, file);
+    putLE(file, datasize, 4);
+    writeSamples(file, channels);
+    fclose(file);
+  }
+
+  void OfflineRenderer::writeRaw(const string& path, const vector<vector<Sample>>& channels)
+  {
+    FILE* file = openForWriting(path);
+    writeSamples(file, channels);
+    fclose(file);
+  }
+}
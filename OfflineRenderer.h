@@ -0,0 +1,58 @@
+#ifndef __OFFLINERENDERER__
+#define __OFFLINERENDERER__
+#include "VoiceManager.h"
+#include "MidiFile.h"
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace syn
+{
+  /**
+   * \class OfflineRenderer
+   *
+   * \brief Renders a MIDI performance through a VoiceManager as fast as possible, without an audio host.
+   *
+   * Processing mirrors the plugin: the voice manager is ticked one block at a time, and blocks are split at MIDI
+   * events so that each event is dispatched at its exact sample.
+   */
+  class OfflineRenderer
+  {
+  public:
+    OfflineRenderer(VoiceManager& vm, double fs, size_t blocksize);
+    /**
+     * \brief Renders the events followed by tail seconds of release, replacing the contents of out with numChannels
+     * channels of samples. Mono instruments are rendered to every channel.
+     */
+    void render(const vector<MidiEvent>& events, double duration, double tail, vector<vector<Sample>>& out,
+                int numChannels = 1);
+    /**
+     * \brief Wall clock time taken by the last call to render(), in seconds.
+     */
+    double getRenderTime() const { return m_renderTime; }
+    /**
+     * \brief Length of the audio produced by the last call to render() divided by the time it took to render it.
+     */
+    double getRealtimeMultiple() const;
+
+    /**
+     * \brief Writes equally long channels of samples to a 32 bit floating point WAV file.
+     */
+    static void writeWav(const string& path, const vector<vector<Sample>>& channels, double fs);
+    /**
+     * \brief Writes channels of samples as headerless, interleaved, native-endian 32 bit floats.
+     */
+    static void writeRaw(const string& path, const vector<vector<Sample>>& channels);
+  private:
+    void dispatch(const MidiEvent& event);
+
+    VoiceManager& m_vm;
+    double m_Fs;
+    size_t m_blockSize;
+    double m_renderTime;
+    size_t m_renderedSamples;
+  };
+}
+#endif
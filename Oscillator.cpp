@@ -1,5 +1,6 @@
 #include "Oscillator.h"
 #include "DSPMath.h"
+#include <algorithm>
 
 namespace syn
 {
@@ -19,13 +20,22 @@ namespace syn
   {
     m_Step = m_Step * m_Fs / fs;
     m_Fs = fs;
+    m_lastPitch = numeric_limits<double>::quiet_NaN();
   }
 
-  void Oscillator::update_step()
+  void Oscillator::resizeOutputBuffer(size_t newbufsize)
   {
-    if (m_pitch.isDirty() || m_finetune.isDirty())
+    SourceUnit::resizeOutputBuffer(newbufsize);
+    m_phases.resize(newbufsize);
+    m_steps.resize(newbufsize);
+  }
+
+  void Oscillator::update_step(double pitch)
+  {
+    if (pitch != m_lastPitch)
     {
-      m_Step = pitchToFreq(m_pitch + m_finetune) / m_Fs;
+      m_Step = pitchToFreq(pitch) / m_Fs;
+      m_lastPitch = pitch;
     }
   }
 
@@ -33,47 +43,235 @@ namespace syn
    * \brief
    * \todo Maybe let Unit inheritors implement a function that gets called only when some parameters have changed
    */
-  void Oscillator::tick_phase()
+  void Oscillator::tick_phase(const ParamBlock& params, size_t n)
   {
-    update_step();
-    m_basePhase += m_Step;
-    if (m_basePhase >= 1)
-      m_basePhase -= 1;
-    m_phase = m_basePhase + m_phaseshift;
-    if (m_phase >= 1) m_phase -= 1;
-    else if (m_phase < 0) m_phase += 1;
+    const Sample* pitch = params[m_pitch];
+    const Sample* finetune = params[m_finetune];
+    const Sample* phaseshift = params[m_phaseshift];
+    Sample* steps = &m_steps[0];
+    Sample* phases = &m_phases[0];
+    if (params.isConstant(m_pitch) && params.isConstant(m_finetune))
+    {
+      update_step(pitch[0] + finetune[0]);
+      std::fill(steps, steps + n, m_Step);
+    }
+    else
+    {
+      for (int i = 0; i < n; i++)
+      {
+        steps[i] = pitch[i] + finetune[i];
+      }
+      m_lastPitch = steps[n - 1];
+      pitchToFreq(steps, steps, n);
+      for (int i = 0; i < n; i++)
+      {
+        steps[i] /= m_Fs;
+      }
+      m_Step = steps[n - 1];
+    }
+    for (int i = 0; i < n; i++)
+    {
+      m_basePhase += steps[i];
+      if (m_basePhase >= 1)
+        m_basePhase -= 1;
+      double phase = m_basePhase + phaseshift[i];
+      if (phase >= 1) phase -= 1;
+      else if (phase < 0) phase += 1;
+      phases[i] = phase;
+    }
+    m_phase = phases[n - 1];
     updateSyncStatus();
   }
 
-  void BasicOscillator::process(int bufind)
+  namespace
+  {
+    /**
+     * Polynomial approximation of the band-limited step residual, for an upward step of 2 at phase 0. It is only
+     * nonzero within one phase increment of the step. Written without branches, so the block loops using it vectorize.
+     */
+    template<typename T>
+    inline T polyblep(T phase, T step)
+    {
+      T after = phase / step;
+      T before = (phase - 1) / step;
+      after = after < 1 ? (2 - after) * after - 1 : T(0);
+      before = before > -1 ? (before + 2) * before + 1 : T(0);
+      return after + before;
+    }
+
+    template<typename T>
+    inline T polyblepPulse(T phase, T step, T width)
+    {
+      width = width < 0 ? T(0) : (width > 1 ? T(1) : width);
+      T shifted = phase - width;
+      shifted += shifted < 0 ? T(1) : T(0);
+      // the naive pulse is offset so that its mean is zero, like the difference of two saws
+      T naive = phase < width ? 2 * width - 2 : 2 * width;
+      return naive - polyblep(phase, step) + polyblep(shifted, step);
+    }
+  }
+
+  inline double shapeWaveform(int waveform, double phase, const LookupTable& blsaw, double width)
   {
-    tick_phase();
-    double output;
-    switch ((int)m_waveform)
+    double shifted = phase - (waveform == PULSE_WAVE ? width : 0.5);
+    shifted += shifted < 0 ? 1.0 : 0.0;
+    switch (waveform)
     {
     case SAW_WAVE:
-      output = lut_bl_saw.getlinear(m_phase);
+      return blsaw.getlinear(phase);
+    case NAIVE_SAW_WAVE:
+      return 2 * (phase - 0.5);
+    case SINE_WAVE:
+      return lut_sin().getlinear(phase);
+    case TRI_WAVE:
+      return phase <= 0.5 ? 4 * phase - 1 : -4 * (phase - 0.5) + 1;
+    case SQUARE_WAVE:
+      return -blsaw.getlinear(shifted) + blsaw.getlinear(phase);
+    case NAIVE_SQUARE_WAVE:
+      return phase <= 0.5 ? -1 : 1;
+    case PULSE_WAVE:
+      return -blsaw.getlinear(shifted) + blsaw.getlinear(phase);
+    default:
+      return 0;
+    }
+  }
+
+  void BasicOscillator::renderSaw(Sample* out, size_t n)
+  {
+    const Sample* phases = &m_phases[0];
+    const Sample* steps = &m_steps[0];
+    const MipmappedTable& blsaw = lut_bl_saw();
+    double maxstep = *std::max_element(steps, steps + n);
+    if (maxstep * blsaw.getMaxHarmonic() < 0.5)
+    {
+      for (int i = 0; i < n; i++)
+      {
+        out[i] = 2 * phases[i] - 1 - polyblep(phases[i], steps[i]);
+      }
+      return;
+    }
+    blsaw.getTable(blsaw.getLevel(maxstep)).getlinear(phases, out, n);
+  }
+
+  void BasicOscillator::renderPulse(const Sample* widths, Sample* out, size_t n)
+  {
+    Sample* phases = &m_phases[0];
+    const Sample* steps = &m_steps[0];
+    const MipmappedTable& blsaw = lut_bl_saw();
+    double maxstep = *std::max_element(steps, steps + n);
+    if (maxstep * blsaw.getMaxHarmonic() < 0.5)
+    {
+      if (widths)
+      {
+        for (int i = 0; i < n; i++)
+        {
+          out[i] = polyblepPulse(phases[i], steps[i], widths[i]);
+        }
+      }
+      else
+      {
+        for (int i = 0; i < n; i++)
+        {
+          out[i] = polyblepPulse(phases[i], steps[i], Sample(0.5));
+        }
+      }
+      return;
+    }
+    const LookupTable& table = blsaw.getTable(blsaw.getLevel(maxstep));
+    table.getlinear(phases, out, n);
+    for (int i = 0; i < n; i++)
+    {
+      phases[i] -= widths ? widths[i] : Sample(0.5);
+      phases[i] += phases[i] < 0 ? Sample(1) : Sample(0);
+    }
+    table.getlinear(phases, phases, n);
+    for (int i = 0; i < n; i++)
+    {
+      out[i] -= phases[i];
+    }
+  }
+
+  template <int WAVEFORM>
+  void BasicOscillator::renderBlock(const ParamBlock& params, Sample* out, size_t n)
+  {
+    const Sample* gain = params[m_gain];
+    const Sample* waveform = params[m_waveform];
+    const Sample* pulsewidth = params[m_pulsewidth];
+    Sample* phases = &m_phases[0];
+    tick_phase(params, n);
+    switch (WAVEFORM)
+    {
+    case SAW_WAVE:
+      renderSaw(out, n);
+      break;
+    case SINE_WAVE:
+      lut_sin().getlinear(phases, out, n);
+      break;
+    case SQUARE_WAVE:
+      renderPulse(nullptr, out, n);
+      break;
+    case PULSE_WAVE:
+      renderPulse(pulsewidth, out, n);
+      break;
+    default:
+      {
+        const Sample* steps = &m_steps[0];
+        const MipmappedTable& blsaw = lut_bl_saw();
+        const LookupTable& table = blsaw.getTable(blsaw.getLevel(*std::max_element(steps, steps + n)));
+        for (int i = 0; i < n; i++)
+        {
+          out[i] = shapeWaveform(WAVEFORM < 0 ? (int)waveform[i] : WAVEFORM, phases[i], table, pulsewidth[i]);
+        }
+      }
+      break;
+    }
+    for (int i = 0; i < n; i++)
+    {
+      out[i] *= m_velocity * gain[i];
+    }
+  }
+
+  void BasicOscillator::processBlock(const ParamBlock& params, Sample* out, size_t n)
+  {
+    if (params.isConstant(m_gain) && params[m_gain][0] == 0)
+    {
+      // the waveform is multiplied by zero, so only the phase needs to advance
+      tick_phase(params, n);
+      std::fill(out, out + n, 0.0);
+      return;
+    }
+    if (!params.isConstant(m_waveform))
+    {
+      renderBlock<-1>(params, out, n);
+      return;
+    }
+    // hoist the waveform selection out of the sample loop
+    switch ((int)params[m_waveform][0])
+    {
+    case SAW_WAVE:
+      renderBlock<SAW_WAVE>(params, out, n);
       break;
     case NAIVE_SAW_WAVE:
-      output = 2 * (m_phase - 0.5);
+      renderBlock<NAIVE_SAW_WAVE>(params, out, n);
       break;
     case SINE_WAVE:
-      output = lut_sin.getlinear(m_phase);
+      renderBlock<SINE_WAVE>(params, out, n);
       break;
     case TRI_WAVE:
-      output = m_phase <= 0.5 ? 4 * m_phase - 1 : -4 * (m_phase - 0.5) + 1;
+      renderBlock<TRI_WAVE>(params, out, n);
       break;
     case SQUARE_WAVE:
-      output = -lut_bl_saw.getlinear(m_phase - 0.5) + lut_bl_saw.getlinear(m_phase);
+      renderBlock<SQUARE_WAVE>(params, out, n);
       break;
     case NAIVE_SQUARE_WAVE:
-      output = m_phase <= 0.5 ? -1 : 1;
+      renderBlock<NAIVE_SQUARE_WAVE>(params, out, n);
+      break;
+    case PULSE_WAVE:
+      renderBlock<PULSE_WAVE>(params, out, n);
       break;
     default:
-      output = 0;
+      renderBlock<NUM_OSC_MODES>(params, out, n);
       break;
     }
-    m_output[bufind] = m_velocity * m_gain * output;
   }
 }
-
@@ -2,6 +2,7 @@
 #define __OSCILLATOR__
 #include <cstdint>
 #include <cmath>
+#include <limits>
 #include <vector>
 #include "SourceUnit.h"
 
@@ -17,10 +18,11 @@ namespace syn
     TRI_WAVE,
     SQUARE_WAVE,
     NAIVE_SQUARE_WAVE,
+    PULSE_WAVE,
     NUM_OSC_MODES
   };
 
-  const vector<string> OSC_MODE_NAMES{"Saw","Naive saw","Sine","Tri","Square","Naive square"};
+  const vector<string> OSC_MODE_NAMES{"Saw","Naive saw","Sine","Tri","Square","Naive square","Pulse"};
 
   class Oscillator : public SourceUnit
   {
@@ -30,7 +32,10 @@ namespace syn
                               m_pitch(addParam("pitch", DOUBLE_TYPE, 0, 128, 0, true)),
                               m_finetune(addParam("tune", DOUBLE_TYPE, -12, 12, 0)),
                               m_phaseshift(addParam("phaseshift", DOUBLE_TYPE, -0.5, 0.5, 0.0)),
-                              m_velocity(1.0)
+                              m_velocity(1.0),
+                              m_lastPitch(numeric_limits<double>::quiet_NaN()),
+                              m_phases(1, 0.0),
+                              m_steps(1, 0.0)
     {
       m_Step = 440. / m_Fs;
       m_Step = m_Step;
@@ -67,6 +72,7 @@ namespace syn
     };
 
     virtual void setFs(double fs) override;
+    virtual void resizeOutputBuffer(size_t newbufsize) override;
     UnitParameter& m_gain;
     UnitParameter& m_pitch;
     UnitParameter& m_finetune;
@@ -76,21 +82,37 @@ namespace syn
     double m_phase = 0;
     double m_Step;
     double m_velocity;
+    double m_lastPitch; //!< pitch (including fine tuning) that m_Step was last computed for
+    SampleVec m_phases; //!< phase of each sample of the current block
+    SampleVec m_steps; //!< phase increment of each sample of the current block
 
     void updateSyncStatus()
     {
       m_isSynced = m_phase < m_Step;
     };
 
-    virtual void tick_phase();
-    virtual void update_step();
+    /**
+     * \brief Advances the oscillator over the first n samples of the block, filling m_phases and m_steps.
+     */
+    void tick_phase(const ParamBlock& params, size_t n);
+    void update_step(double pitch);
+    virtual void copyStateImpl(const Unit& other) override
+    {
+      const Oscillator& osc = static_cast<const Oscillator&>(other);
+      m_basePhase = osc.m_basePhase;
+      m_phase = osc.m_phase;
+      m_Step = osc.m_Step;
+      m_velocity = osc.m_velocity;
+      m_lastPitch = osc.m_lastPitch;
+    }
   };
 
   class BasicOscillator : public Oscillator
   {
   public:
     BasicOscillator(string name) : Oscillator(name),
-                                   m_waveform(addEnumParam("waveform", OSC_MODE_NAMES))
+                                   m_waveform(addEnumParam("waveform", OSC_MODE_NAMES)),
+                                   m_pulsewidth(addParam("pulsewidth", DOUBLE_TYPE, 0.05, 0.95, 0.5))
     {
     };
 
@@ -99,9 +121,29 @@ namespace syn
     };
 
     UnitParameter& m_waveform;
+    UnitParameter& m_pulsewidth; //!< fraction of the period the pulse waveform spends high
   protected:
-    virtual void process(int bufind) override;
+    virtual void processBlock(const ParamBlock& params, Sample* out, size_t n) override;
   private:
+    /**
+     * \brief Renders a block with a fixed waveform, or with a per-sample waveform if WAVEFORM is negative.
+     */
+    template <int WAVEFORM>
+    void renderBlock(const ParamBlock& params, Sample* out, size_t n);
+
+    /**
+     * \brief Renders a band-limited saw from m_phases and m_steps.
+     *
+     * The mipmap level is picked from the largest phase increment of the block. Pitches too low for the richest level
+     * to hold every harmonic below Nyquist are rendered with polyBLEP correction instead, which barely aliases there.
+     */
+    void renderSaw(Sample* out, size_t n);
+    /**
+     * \brief Renders a band-limited pulse as the difference of two saws, with the given width per sample or a
+     * square wave if widths is null. Clobbers m_phases.
+     */
+    void renderPulse(const Sample* widths, Sample* out, size_t n);
+
     virtual Unit* cloneImpl() const override
     {
       return new BasicOscillator(*this);
@@ -48,13 +48,15 @@ namespace syn
     const Unit* currInput = getSourceUnit();
     const SourceUnit* currTrigger = getTriggerUnit();
     if(currInput==nullptr || currTrigger==nullptr) return;
-    const vector<double>& srcbuffer = currInput->getLastOutputBuffer();
-    if (m_inputRingBuffer.size() <= srcbuffer.size())
+    // only the first channel is displayed
+    const Sample* srcbuffer = currInput->getOutputChannel(0);
+    const size_t bufsize = currInput->getBufferSize();
+    if (m_inputRingBuffer.size() <= bufsize)
     {
-      setPeriod(srcbuffer.size());
+      setPeriod(bufsize);
     }
     int period = getPeriod();
-    for (int i = 0; i < srcbuffer.size(); i++)
+    for (int i = 0; i < bufsize; i++)
     {
       m_BufInd++;
       if (m_BufInd >= m_inputRingBuffer.size() - 1)
@@ -0,0 +1,154 @@
+#include "PatchLoader.h"
+#include "SourceUnit.h"
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <cstring>
+#include <vector>
+
+using std::vector;
+
+namespace syn
+{
+  namespace
+  {
+    /**
+     * Reads values the way IPlug's ByteChunk::Get and ByteChunk::GetStr do: raw native-endian bytes, with strings
+     * stored as an int length followed by the unterminated characters.
+     */
+    class ChunkReader
+    {
+    public:
+      ChunkReader(const char* data, size_t size, size_t pos) :
+        m_data(data),
+        m_size(size),
+        m_pos(pos)
+      {}
+
+      template <typename T>
+      T get()
+      {
+        T value;
+        read(&value, sizeof(T));
+        return value;
+      }
+
+      string getStr()
+      {
+        int len = get<int>();
+        if (len < 0)
+          throw std::invalid_argument("Malformed patch: negative string length.");
+        string str(len, '\0');
+        read(&str[0], len);
+        return str;
+      }
+
+      template <typename T>
+      T peek()
+      {
+        size_t pos = m_pos;
+        T value = get<T>();
+        m_pos = pos;
+        return value;
+      }
+
+      size_t getPos() const { return m_pos; }
+      size_t remaining() const { return m_size - m_pos; }
+    private:
+      void read(void* dst, size_t n)
+      {
+        if (m_pos + n > m_size)
+          throw std::invalid_argument("Malformed patch: unexpected end of data.");
+        memcpy(dst, m_data + m_pos, n);
+        m_pos += n;
+      }
+
+      const char* m_data;
+      size_t m_size;
+      size_t m_pos;
+    };
+  }
+
+  Instrument* PatchLoader::load(const char* data, size_t size, size_t startpos, size_t* endpos)
+  {
+    ChunkReader reader(data, size, startpos);
+    Instrument* instr = new Instrument();
+    try
+    {
+      unsigned int numunits = reader.get<unsigned int>();
+      for (int i = 0; i < numunits; i++)
+      {
+        unsigned int unitClassId = reader.get<unsigned int>();
+        int unitid = reader.get<int>();
+        bool isSource = reader.get<bool>();
+        bool isPrimarySource = reader.get<bool>();
+        bool isSink = reader.get<bool>();
+
+        Unit* unit;
+        try
+        {
+          unit = isSource ? m_factory.createSourceUnit(unitClassId) : m_factory.createUnit(unitClassId);
+        }
+        catch (std::out_of_range&)
+        {
+          throw std::invalid_argument("Patch contains a unit of unknown class (" + std::to_string(unitClassId) + ").");
+        }
+
+        // add the unit right away so the instrument takes ownership of it
+        int uid = isSource ? instr->addSource(dynamic_cast<SourceUnit*>(unit), unitid) : instr->addUnit(unit, unitid);
+        if (isSink) instr->setSinkId(uid);
+        if (isPrimarySource) instr->resetPrimarySource(uid);
+
+        unsigned int numparams = reader.get<unsigned int>();
+        for (int j = 0; j < numparams; j++)
+        {
+          string paramname = reader.getStr();
+          double paramval = reader.get<double>();
+          int paramid = unit->getParamId(paramname);
+          if (paramid == -1)
+          {
+            continue;
+          }
+          unit->modifyParameter(paramid, paramval, SET);
+        }
+        // GUI window size and position
+        reader.get<int>();
+        reader.get<int>();
+        reader.get<int>();
+      }
+
+      for (int i = 0; i < numunits; i++)
+      {
+        unsigned int numConns = reader.get<unsigned int>();
+        for (int j = 0; j < numConns; j++)
+        {
+          instr->addConnection(reader.get<ConnectionMetadata>());
+        }
+      }
+
+      // optional settings, absent from older patches
+      if (reader.remaining() >= sizeof(unsigned int) + sizeof(int) && reader.peek<unsigned int>() == PATCH_OVERSAMPLING_TAG)
+      {
+        reader.get<unsigned int>();
+        instr->setOversampling(reader.get<int>());
+      }
+    }
+    catch (...)
+    {
+      delete instr;
+      throw;
+    }
+    if (endpos)
+      *endpos = reader.getPos();
+    return instr;
+  }
+
+  Instrument* PatchLoader::loadFile(const string& path, size_t startpos)
+  {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+      throw std::invalid_argument("Unable to open patch file: " + path);
+    vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return load(data.data(), data.size(), startpos);
+  }
+}
@@ -0,0 +1,38 @@
+#ifndef __PATCHLOADER__
+#define __PATCHLOADER__
+#include "Instrument.h"
+#include "UnitFactory.h"
+#include <string>
+
+#define PATCH_OVERSAMPLING_TAG 0x4F56534D //!< "OVSM", precedes the oversampling factor stored after the connections
+
+using std::string;
+
+namespace syn
+{
+  /**
+   * \class PatchLoader
+   *
+   * \brief Builds an Instrument from a patch in the format written by CircuitPanel::serialize.
+   *
+   * Does not depend on IPlug, so patches saved by the plugin can be loaded by headless tools. The GUI layout stored
+   * in the patch is skipped.
+   */
+  class PatchLoader
+  {
+  public:
+    PatchLoader(UnitFactory& factory) :
+      m_factory(factory)
+    {}
+    /**
+     * \brief Reads a patch starting at byte startpos of data. Throws std::invalid_argument if the patch is truncated
+     * or refers to an unknown unit class.
+     * \param endpos If not null, receives the position of the first byte following the patch.
+     */
+    Instrument* load(const char* data, size_t size, size_t startpos = 0, size_t* endpos = nullptr);
+    Instrument* loadFile(const string& path, size_t startpos = 0);
+  private:
+    UnitFactory& m_factory;
+  };
+}
+#endif
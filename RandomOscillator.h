@@ -42,20 +42,26 @@ namespace syn
     virtual ~UniformRandomOscillator() {}
   protected:
     uint32_t m_curr,m_next;
-    virtual void update_step() override
+    virtual void copyStateImpl(const Unit& other) override
     {
-      double freq = pitchToFreq(m_pitch + m_finetune);
-      m_Step = freq / (m_Fs);
+      Oscillator::copyStateImpl(other);
+      const UniformRandomOscillator& osc = static_cast<const UniformRandomOscillator&>(other);
+      m_curr = osc.m_curr;
+      m_next = osc.m_next;
     }
-    virtual void process(int bufind) override
+    virtual void processBlock(const ParamBlock& params, Sample* out, size_t n) override
     {
-      tick_phase();
-      if (m_isSynced)
+      const Sample* gain = params[m_gain];
+      tick_phase(params, n);
+      for (int i = 0; i < n; i++)
       {
-        m_curr = m_next;
-        m_next = 69069*m_next+1;
+        if (m_phases[i] < m_steps[i])
+        {
+          m_curr = m_next;
+          m_next = 69069*m_next+1;
+        }
+        out[i] = gain[i]*(LERP((m_curr / double(0x7FFFFFFF)), (m_next/double(0x7FFFFFFF)), m_phases[i])-1.0);
       }
-      m_output[bufind] = m_gain*(LERP((m_curr / double(0x7FFFFFFF)), (m_next/double(0x7FFFFFFF)), m_phase)-1.0);
     }
   private:
     virtual Unit* cloneImpl() const override
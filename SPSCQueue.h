@@ -0,0 +1,63 @@
+#ifndef __SPSCQUEUE__
+#define __SPSCQUEUE__
+#include <atomic>
+#include <cstddef>
+
+namespace syn
+{
+  /**
+   * \class SPSCQueue
+   *
+   * \brief A bounded, lock-free FIFO for exactly one producer thread and one consumer thread.
+   *
+   * Holds at most SIZE-1 elements, where SIZE is a power of two. Neither push() nor pop() blocks or allocates, so
+   * either end may be used from the audio thread.
+   */
+  template <typename T, size_t SIZE>
+  class SPSCQueue
+  {
+    static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "SPSCQueue size must be a power of two");
+  public:
+    SPSCQueue() :
+      m_head(0),
+      m_tail(0)
+    {}
+
+    /**
+     * \brief Appends an element. Producer only.
+     * \returns false, leaving the queue untouched, if the queue is full.
+     */
+    bool push(const T& item)
+    {
+      size_t tail = m_tail.load(std::memory_order_relaxed);
+      size_t next = (tail + 1) & (SIZE - 1);
+      if (next == m_head.load(std::memory_order_acquire))
+        return false;
+      m_items[tail] = item;
+      m_tail.store(next, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * \brief Removes the oldest element. Consumer only.
+     * \returns false if the queue is empty.
+     */
+    bool pop(T& item)
+    {
+      size_t head = m_head.load(std::memory_order_relaxed);
+      if (head == m_tail.load(std::memory_order_acquire))
+        return false;
+      item = m_items[head];
+      m_head.store((head + 1) & (SIZE - 1), std::memory_order_release);
+      return true;
+    }
+
+    bool empty() const { return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire); }
+  private:
+    T m_items[SIZE];
+    std::atomic<size_t> m_head; //!< index of the oldest element, written by the consumer
+    char m_pad[64]; //!< keeps the two indices on separate cache lines
+    std::atomic<size_t> m_tail; //!< index one past the newest element, written by the producer
+  };
+}
+#endif
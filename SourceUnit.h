@@ -5,8 +5,21 @@
 
 using Gallant::Signal0;
 
+#define MIDI_CC_MOD_WHEEL 1
+#define MIDI_CC_SUSTAIN 64
+#define NUM_MIDI_CCS 128
+
 namespace syn
 {
+  enum MIDI_CONTROL
+  {
+    PITCH_BEND = 0,
+    CHANNEL_PRESSURE,
+    POLY_PRESSURE,
+    CONTROL_CHANGE,
+    NUM_MIDI_CONTROLS
+  };
+
   class SourceUnit :
     public Unit
   {
@@ -19,6 +32,11 @@ namespace syn
     virtual void noteOff(int pitch, int vel) = 0;
     virtual int getSamplesPerPeriod() const = 0;
     virtual bool isActive() const = 0;
+    /**
+     * \brief Receives a change of one of the voice's MIDI controllers. num is the controller number of a
+     * CONTROL_CHANGE, and value is normalized to [0,1], or to [-1,1] for PITCH_BEND.
+     */
+    virtual void onMidiControl(MIDI_CONTROL control, int num, double value) {};
     bool isSynced() const { return m_isSynced; };
   protected:
     bool m_isSynced;
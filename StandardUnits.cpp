@@ -0,0 +1,24 @@
+#include "StandardUnits.h"
+#include "Envelope.h"
+#include "Oscillator.h"
+#include "VosimOscillator.h"
+#include "RandomOscillator.h"
+#include "MidiControl.h"
+#include "Filter.h"
+
+namespace syn
+{
+  void registerStandardUnits(UnitFactory& factory)
+  {
+    factory.addSourceUnitPrototype(new Envelope("Envelope"));
+    factory.addUnitPrototype(new AccumulatingUnit("Accumulator"));
+    factory.addUnitPrototype(new Filter("Filter"));
+    factory.addUnitPrototype(new PanningUnit("Pan"));
+    factory.addSourceUnitPrototype(new VosimOscillator("Osc.VOSIM"));
+    factory.addSourceUnitPrototype(new VosimChoir("Osc.VOSIM.Choir"));
+    factory.addSourceUnitPrototype(new UniformRandomOscillator("Osc.Random.Normal"));
+    factory.addSourceUnitPrototype(new BasicOscillator("Osc.Basic"));
+    factory.addSourceUnitPrototype(new LFOOscillator("Osc.LFO"));
+    factory.addSourceUnitPrototype(new MidiControlUnit("MIDI"));
+  }
+}
@@ -0,0 +1,15 @@
+#ifndef __STANDARDUNITS__
+#define __STANDARDUNITS__
+#include "UnitFactory.h"
+
+namespace syn
+{
+  /**
+   * \brief Registers the prototypes of every unit that can be placed in a patch.
+   *
+   * Shared by the plugin and the offline renderer, so both resolve the class identifiers stored in a patch the same
+   * way.
+   */
+  void registerStandardUnits(UnitFactory& factory);
+}
+#endif
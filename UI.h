@@ -34,5 +34,11 @@ namespace syn
     {0xFFC5AFA0},
     {0xFFE9BCB7}
   };
+
+  inline IRECT shiftIRECT(const IRECT& a_irect, int a_x, int a_y)
+  {
+    IRECT shifted{a_irect.L + a_x, a_irect.T + a_y, a_irect.R + a_x, a_irect.B + a_y};
+    return shifted;
+  }
 }
 #endif
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "Unit.h"
 #include <array>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
 
 using namespace std;
 
@@ -25,22 +28,37 @@ namespace syn
     Unit* u = cloneImpl();
     u->m_name = m_name;
     u->m_Fs = m_Fs;
+    u->resizeOutputBuffer(m_bufSize);
     u->m_output = m_output;
     u->m_parammap = m_parammap;
     u->m_bufind = m_bufind;
+    u->m_outputFlags = m_outputFlags;
     for (int i = 0; i < m_params.size(); i++)
     {
       u->m_params[i]->mod(*m_params[i], SET);
+      u->m_params[i]->setSmoothing(m_params[i]->getSmoothingMode(), m_params[i]->getSmoothingTime());
     }
     return u;
   }
 
+  void Unit::copyState(const Unit& other)
+  {
+    if (other.m_output.size() == m_output.size())
+    {
+      std::copy(other.m_output.begin(), other.m_output.end(), m_output.begin());
+      m_bufind = other.m_bufind;
+      m_outputFlags = other.m_outputFlags;
+    }
+    copyStateImpl(other);
+  }
+
   UnitParameter& Unit::addParam(string name, int id, PARAM_TYPE ptype, const double min, const double max, const double defaultValue, const bool isHidden)
   {
     m_parammap[name] = id;
     if (m_params.size() <= id)
       m_params.resize(id + 1);
     m_params[id] = new UnitParameter(this, name, id, ptype, min, max, defaultValue, isHidden);
+    m_params[id]->resizeBlock(m_bufSize);
     return *m_params[id];
   }
 
@@ -63,10 +81,34 @@ namespace syn
     m_Fs(44100.0),
     m_output(1, 0.0),
     m_bufind(0),
+    m_numChannels(1),
+    m_bufSize(1),
+    m_outputFlags({ false, false }),
     m_name(name),
     m_parent(nullptr)
   {}
 
+  unsigned int Unit::classIdentifier(const string& classname, bool wide)
+  {
+    if (wide)
+    {
+      uint64_t h = 14695981039346656037ULL;
+      for (int i = 0; i < classname.size(); i++)
+      {
+        h ^= uint64_t((unsigned char)classname[i]);
+        h *= 1099511628211ULL;
+      }
+      return (unsigned int)(h & 0xFFFFFFFF);
+    }
+    uint32_t h = 2166136261U;
+    for (int i = 0; i < classname.size(); i++)
+    {
+      h ^= uint32_t((unsigned char)classname[i]);
+      h *= 16777619U;
+    }
+    return h;
+  }
+
   Unit::~Unit()
   {
     // delete allocated parameters
@@ -76,24 +118,80 @@ namespace syn
     }
   }
 
-  void Unit::tick()
+  void Unit::setNumChannels(int numChannels)
+  {
+    m_numChannels = numChannels;
+    m_output.resize(m_bufSize * m_numChannels);
+  }
+
+  void Unit::resizeOutputBuffer(size_t newbufsize)
+  {
+    m_bufSize = newbufsize;
+    m_output.resize(newbufsize * m_numChannels);
+    for (int i = 0; i < m_params.size(); i++)
+    {
+      m_params[i]->resizeBlock(newbufsize);
+    }
+  }
+
+  void Unit::tick(size_t bufsize)
   {
     beginProcessing();
-    for (int i = 0; i < m_output.size(); i++)
+    bool isConstant = isStateless();
+    for (int j = 0; j < m_params.size(); j++)
     {
-      for (int j = 0; j < m_params.size(); j++)
+      m_params[j]->pullBlock(bufsize);
+      isConstant = isConstant && m_params[j]->isConstant();
+    }
+    Sample* out = &m_output[0];
+    if (isConstant)
+    {
+      processBlock(ParamBlock(m_params), out, 1);
+      for (int c = 0; c < m_numChannels; c++)
       {
-        m_params[j]->reset();
-        if (m_params[j]->numConnections()>0) {
-          m_params[j]->pull(i);
+        Sample* channel = out + c * m_bufSize;
+        std::fill(channel + 1, channel + bufsize, channel[0]);
+      }
+    }
+    else
+    {
+      processBlock(ParamBlock(m_params), out, bufsize);
+      // flag constant blocks, so that the parameters this unit modulates can fold it
+      isConstant = true;
+      for (int c = 0; c < m_numChannels && isConstant; c++)
+      {
+        const Sample* channel = out + c * m_bufSize;
+        int i = 1;
+        while (i < bufsize && channel[i] == channel[0])
+        {
+          i++;
         }
+        isConstant = i >= bufsize;
       }
-      process(i);
-      m_bufind = i;
     }
+    bool isSilent = isConstant;
+    for (int c = 0; c < m_numChannels && isSilent; c++)
+    {
+      isSilent = out[c * m_bufSize] == 0;
+    }
+    m_bufind = bufsize - 1;
+    m_outputFlags.isConstant = isConstant;
+    m_outputFlags.isSilent = isSilent;
     finishProcessing();
   }
 
+  void Unit::processBlock(const ParamBlock& params, Sample* out, size_t n)
+  {
+    for (int i = 0; i < n; i++)
+    {
+      for (int j = 0; j < m_params.size(); j++)
+      {
+        m_params[j]->seek(i);
+      }
+      process(i);
+    }
+  }
+
   int Unit::getParamId(string name)
   {
     int paramid;
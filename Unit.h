@@ -5,17 +5,45 @@
 #include <unordered_map>
 #include <vector>
 #include <functional>
+#include <algorithm>
 
 using Gallant::Signal1;
 using std::unordered_map;
 using std::vector;
-using std::hash;
 
 namespace syn
 {
   typedef unordered_map<string, int> IDMap; //!< string to array index translation map
 
   class Circuit; // forward decl.
+  class UnitFactory;
+
+  /**
+   * \class ParamBlock
+   *
+   * \brief Read-only view of a Unit's parameters over a single processing block.
+   *
+   * Each parameter is exposed as a contiguous array holding its modulated value for every sample of the block.
+   */
+  class ParamBlock
+  {
+  public:
+    ParamBlock(const vector<UnitParameter*>& params) :
+      m_params(params)
+    {}
+    const Sample* operator[](int pid) const { return m_params[pid]->getBlock(); }
+    const Sample* operator[](const UnitParameter& param) const { return param.getBlock(); }
+    /**
+     * \brief Block of one channel of a parameter with several channels, see UnitParameter::setNumChannels().
+     */
+    const Sample* channel(const UnitParameter& param, int c) const { return param.getChannel(c); }
+    bool isConstant(int pid) const { return m_params[pid]->isConstant(); }
+    bool isConstant(const UnitParameter& param) const { return param.isConstant(); }
+    size_t size() const { return m_params.size(); }
+  private:
+    const vector<UnitParameter*>& m_params;
+  };
+
 /**
  * \class Unit
  *
@@ -26,22 +54,57 @@ namespace syn
  * form of numbered parameters (UnitParameter).
  *
  */
-  class Unit
+  class Unit : public ArenaAllocated
   {
     friend class Circuit;
+    friend class UnitFactory;
   public:
     Unit(string name);
     virtual ~Unit();
     virtual void setFs(double fs) { m_Fs = fs; };
-    const unsigned int getClassIdentifier() const { hash<string> hash_fn; return hash_fn(getClassName()); };
     /*!
-     * \brief Runs the unit for the specified number of ticks. The result is accessed via getLastOutputBuffer().
+     * \brief Identifies the unit's class in serialized patches. The same on every platform, see classIdentifier().
      */
-    void tick();
+    const unsigned int getClassIdentifier() const { return classIdentifier(getClassName()); };
+    /*!
+     * \brief Hashes a class name to a class identifier.
+     *
+     * The identifier is the low 32 bits of the 64 bit FNV-1a hash of the name, which is what std::hash<string>
+     * produced in the 64 bit MSVC builds, so existing patches keep loading. If wide is false, the 32 bit FNV-1a
+     * hash is returned instead, matching the 32 bit builds.
+     */
+    static unsigned int classIdentifier(const string& classname, bool wide = true);
+    /*!
+     * \brief Runs the unit for one block. The result is accessed via getLastOutputBuffer().
+     */
+    void tick() { tick(m_bufSize); }
+    /*!
+     * \brief Runs the unit for the first n samples of its buffer only, where n is at most the buffer size.
+     */
+    void tick(size_t n);
     double getFs() const { return m_Fs; };
-    const vector<double>& getLastOutputBuffer() const { return m_output; };
-    double getLastOutput() const { return m_output[m_output.size() - 1]; };
-    virtual void resizeOutputBuffer(size_t newbufsize) { m_output.resize(newbufsize); }
+    const SampleVec& getLastOutputBuffer() const { return m_output; };
+    /*!
+     * \brief Number of output channels. The channels are stored one after the other in the output buffer, so
+     * consumers that only read the start of the buffer see the first channel.
+     */
+    int getNumChannels() const { return m_numChannels; }
+    /*!
+     * \brief Number of samples of each output channel.
+     */
+    size_t getBufferSize() const { return m_bufSize; }
+    const Sample* getOutputChannel(int c) const { return &m_output[c * m_bufSize]; }
+    /*!
+     * \brief Returns true if every sample of every channel of the last output block is zero.
+     */
+    bool isSilent() const { return m_outputFlags.isSilent; }
+    /*!
+     * \brief Returns true if every channel of the last output block holds a single value, which may differ between
+     * channels.
+     */
+    bool isOutputConstant() const { return m_outputFlags.isConstant; }
+    double getLastOutput() const { return m_output[m_bufind]; };
+    virtual void resizeOutputBuffer(size_t newbufsize);
     /*!
      *\brief Modifies the value of the parameter associated with portid.
      */
@@ -51,12 +114,18 @@ namespace syn
     double readParam(int id) const { return *m_params[id]; };
     UnitParameter& getParam(string pname) { return *m_params[m_parammap.at(pname)]; }
     UnitParameter& getParam(int pid) { return *m_params[pid]; }
+    int getNumParameters() const { return (int)m_params.size(); }
     vector<string> getParameterNames() const;
     int getParamId(string name);
     Circuit& getParent() const { return *m_parent; };
     string getName() const { return m_name; }
     void setName(string name) { m_name = name; }
     Unit* clone() const;
+    /*!
+     * \brief Takes over the running state of another unit of the same class, such as an oscillator's phase or an
+     * envelope's current segment, along with its last output block. Parameters are left untouched.
+     */
+    void copyState(const Unit& other);
   protected:
     typedef vector<UnitParameter*> ParamVec;
     ParamVec m_params;
@@ -64,14 +133,35 @@ namespace syn
     string m_name;
     Circuit* m_parent;
     double m_Fs;
-    vector<double> m_output;
-    virtual void process(int bufind) = 0; //<! should add its result to m_output[bufind]
+    SampleVec m_output;
+    /*!
+     * \brief Produces the next n samples of output.
+     *
+     * Parameter values for each sample of the block are available through params. The default implementation falls
+     * back to calling process() once per sample, so units only need to override one of the two. Units with several
+     * channels write channel c from out + c * getBufferSize().
+     */
+    virtual void processBlock(const ParamBlock& params, Sample* out, size_t n);
+    virtual void process(int bufind) {}; //<! per-sample fallback, should write its result to m_output[bufind]
+    /*!
+     * \brief Returns true if processing does not change the unit's state, so that its output over a block with
+     * constant parameters is constant too. Such blocks are folded: only their first sample is processed.
+     */
+    virtual bool isStateless() const { return false; }
+    /*!
+     * \brief Sets the number of output channels, from the constructor of units that produce more than one.
+     */
+    void setNumChannels(int numChannels);
     UnitParameter& addEnumParam(string name, const vector<string> choice_names);
     UnitParameter& addParam(string name, int id, PARAM_TYPE ptype, const double min, const double max, const double defaultValue, const bool isHidden=false);
     UnitParameter& addParam(string name, PARAM_TYPE ptype, const double min, const double max, const double defaultValue, const bool isHidden=false);
   private:
     int m_bufind;
+    int m_numChannels;
+    size_t m_bufSize; //!< number of samples of each channel of m_output
+    BlockFlags m_outputFlags;
     virtual Unit* cloneImpl() const = 0;
+    virtual void copyStateImpl(const Unit& other) {}; //!< Copies the state of subclasses. other is of the same class.
     virtual inline string getClassName() const = 0;
     virtual void beginProcessing() {};
     virtual void finishProcessing() {}; //<! Allows parent classes to apply common processing to child class outputs.
@@ -91,15 +181,90 @@ namespace syn
     {}
     virtual ~AccumulatingUnit() {};
   protected:
-    virtual void process(int bufind) override
+    virtual void processBlock(const ParamBlock& params, Sample* out, size_t n) override
     {
-      m_output[bufind] = m_input*m_gain;
+      const Sample* input = params[m_input];
+      const Sample* gain = params[m_gain];
+      if (params.isConstant(m_gain))
+      {
+        const Sample g = gain[0];
+        if (g == 0)
+        {
+          std::fill(out, out + n, 0.0);
+        }
+        else if (g == 1)
+        {
+          std::copy(input, input + n, out);
+        }
+        else
+        {
+          for (int i = 0; i < n; i++)
+          {
+            out[i] = input[i] * g;
+          }
+        }
+      }
+      else
+      {
+        for (int i = 0; i < n; i++)
+        {
+          out[i] = input[i] * gain[i];
+        }
+      }
     }
+    virtual bool isStateless() const override { return true; }
   private:
     UnitParameter& m_input;
     UnitParameter& m_gain;
     virtual Unit* cloneImpl() const override { return new AccumulatingUnit(*this); }
     virtual string getClassName() const override { return "AccumulatingUnit"; }
   };
+
+  /**
+   * \class PanningUnit
+   *
+   * \brief Stereo output stage: scales a stereo input by its gain and balances it between the left and right
+   * channels.
+   *
+   * Mono sources feed both input channels. At the center both channels pass unchanged; panning fades the opposite
+   * channel out linearly.
+   */
+  class PanningUnit : public Unit
+  {
+  public:
+    PanningUnit(string name) : Unit(name),
+      m_input(addParam("input", DOUBLE_TYPE, -1, 1, 0.0, true)),
+      m_gain(addParam("gain", DOUBLE_TYPE, 0, 1, 0.5)),
+      m_pan(addParam("pan", DOUBLE_TYPE, -1, 1, 0.0))
+    {
+      setNumChannels(2);
+      m_input.setNumChannels(2);
+    }
+    PanningUnit(const PanningUnit& other) : PanningUnit(other.m_name)
+    {}
+    virtual ~PanningUnit() {};
+  protected:
+    virtual void processBlock(const ParamBlock& params, Sample* out, size_t n) override
+    {
+      const Sample* left = params.channel(m_input, 0);
+      const Sample* right = params.channel(m_input, 1);
+      const Sample* gain = params[m_gain];
+      const Sample* pan = params[m_pan];
+      Sample* outleft = out;
+      Sample* outright = out + getBufferSize();
+      for (int i = 0; i < n; i++)
+      {
+        outleft[i] = left[i] * (gain[i] * std::min(1.0, 1.0 - pan[i]));
+        outright[i] = right[i] * (gain[i] * std::min(1.0, 1.0 + pan[i]));
+      }
+    }
+    virtual bool isStateless() const override { return true; }
+  private:
+    UnitParameter& m_input;
+    UnitParameter& m_gain;
+    UnitParameter& m_pan;
+    virtual Unit* cloneImpl() const override { return new PanningUnit(*this); }
+    virtual string getClassName() const override { return "PanningUnit"; }
+  };
 }
 #endif
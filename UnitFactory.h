@@ -2,6 +2,7 @@
 #include "Unit.h"
 #include "SourceUnit.h"
 #include <vector>
+#include <cstdio>
 
 using std::vector;
 
@@ -30,7 +31,7 @@ namespace syn
       m_unit_prototypes.push_back(prototype);
       m_prototype_names.push_back(prototype->getName());
       m_unit_counts.push_back(0);
-      m_class_identifiers[prototype->getClassIdentifier()] = m_unit_prototypes.size() - 1;
+      addClassIdentifiers(prototype, m_unit_prototypes.size() - 1);
     }
 
     void addSourceUnitPrototype(const SourceUnit* prototype)
@@ -38,7 +39,7 @@ namespace syn
       m_source_unit_prototypes.push_back(prototype);
       m_source_prototype_names.push_back(prototype->getName());
       m_source_unit_counts.push_back(0);
-      m_class_identifiers[prototype->getClassIdentifier()] = m_source_unit_prototypes.size() - 1;
+      addClassIdentifiers(prototype, m_source_unit_prototypes.size() - 1);
     }
 
     const vector<string>& getPrototypeNames() const
@@ -93,6 +94,16 @@ namespace syn
       return createUnit(protonum);
     }
   protected:
+    /**
+     * \brief Maps both the 64 and 32 bit build variants of the prototype's class identifier to the prototype, so
+     * patches written by either build can be loaded.
+     */
+    void addClassIdentifiers(const Unit* prototype, int protonum)
+    {
+      m_class_identifiers[prototype->getClassIdentifier()] = protonum;
+      m_class_identifiers[Unit::classIdentifier(prototype->getClassName(), false)] = protonum;
+    }
+
     vector<const Unit*> m_unit_prototypes;
     vector<int> m_unit_counts;
     vector<const SourceUnit*> m_source_unit_prototypes;
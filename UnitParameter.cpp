@@ -1,6 +1,10 @@
 #include "UnitParameter.h"
 #include "Unit.h"
 #include <utility>
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <cmath>
 
 bool syn::UnitParameter::operator==(const UnitParameter& p) const
 {
@@ -15,6 +19,8 @@ void syn::UnitParameter::mod(double amt, MOD_ACTION action)
     m_baseValue = amt;
     m_currValue = amt;
     m_needsUpdate = true;
+    m_smoothedValue = amt;
+    m_rampRemaining = 0;
   }
   else if (action == ADD && amt != 0)
   {
@@ -28,6 +34,296 @@ void syn::UnitParameter::mod(double amt, MOD_ACTION action)
   }
 }
 
+void syn::UnitParameter::modAt(double value, int offset)
+{
+  if (m_numChanges == MAX_PARAM_CHANGES)
+  { // out of room, so the latest change replaces the one scheduled last
+    m_numChanges--;
+    if (m_changes[m_numChanges].offset > offset)
+      offset = m_changes[m_numChanges].offset;
+  }
+  int i = m_numChanges;
+  while (i > 0 && m_changes[i - 1].offset > offset)
+  {
+    m_changes[i] = m_changes[i - 1];
+    i--;
+  }
+  m_changes[i] = { offset, value };
+  m_numChanges++;
+}
+
+void syn::UnitParameter::setSmoothing(SMOOTHING_MODE mode, double seconds)
+{
+  m_smoothingMode = mode;
+  m_smoothingTime = seconds;
+}
+
+void syn::UnitParameter::setTarget(double value)
+{
+  m_baseValue = value;
+  double samples = m_smoothingTime * m_parent->getFs();
+  if (m_smoothingMode == NO_SMOOTHING || samples < 1)
+  {
+    m_smoothedValue = value;
+    m_rampRemaining = 0;
+  }
+  else if (m_smoothingMode == LINEAR_SMOOTHING)
+  {
+    m_rampRemaining = int(samples);
+    m_rampStep = (value - m_smoothedValue) / m_rampRemaining;
+  }
+  else
+  {
+    m_rampStep = exp(-1.0 / samples);
+  }
+}
+
+void syn::UnitParameter::rampBlock(Sample* block, size_t n)
+{
+  int c = 0;
+  for (int j = 0; j < n; j++)
+  {
+    while (c < m_numChanges && m_changes[c].offset <= j)
+    {
+      setTarget(m_changes[c].value);
+      c++;
+    }
+    if (m_smoothedValue != m_baseValue)
+    {
+      if (m_smoothingMode == LINEAR_SMOOTHING)
+      {
+        m_smoothedValue = --m_rampRemaining > 0 ? m_smoothedValue + m_rampStep : m_baseValue;
+      }
+      else
+      {
+        m_smoothedValue = m_baseValue + m_rampStep * (m_smoothedValue - m_baseValue);
+        if (fabs(m_smoothedValue - m_baseValue) < SMOOTHING_EPSILON)
+          m_smoothedValue = m_baseValue;
+      }
+    }
+    block[j] = m_smoothedValue;
+  }
+  // changes past the end of the block stay scheduled, relative to the start of the next one
+  for (int i = c; i < m_numChanges; i++)
+  {
+    m_changes[i - c] = { m_changes[i].offset - int(n), m_changes[i].value };
+  }
+  m_numChanges -= c;
+}
+
+void syn::UnitParameter::fillBlock(double value, size_t n)
+{
+  Sample* block = &m_block[0];
+  const Sample sample = Sample(value);
+  // the block only needs to be rewritten if the value changed since the last block
+  if (!m_isConstant || m_blockData != block || m_blockSize < n || block[0] != sample)
+  {
+    std::fill(block, block + n, sample);
+    m_blockSize = n;
+  }
+  m_blockData = block;
+  m_isConstant = true;
+}
+
+void syn::UnitParameter::setNumChannels(int numChannels)
+{
+  size_t bufsize = m_block.size() / m_numChannels;
+  m_numChannels = numChannels;
+  resizeBlock(bufsize);
+}
+
+void syn::UnitParameter::pullChannels(size_t n)
+{
+  size_t stride = m_block.size() / m_numChannels;
+  Sample* base = &m_block[0];
+  if (m_numChanges > 0 || m_smoothedValue != m_baseValue)
+    rampBlock(base, n);
+  else
+    std::fill(base, base + n, m_baseValue);
+  for (int ch = 1; ch < m_numChannels; ch++)
+  {
+    std::copy(base, base + n, &m_block[ch * stride]);
+  }
+  for (int ch = 0; ch < m_numChannels; ch++)
+  {
+    Sample* block = &m_block[ch * stride];
+    for (int i = 0; i < m_connections.size(); i++)
+    {
+      if (m_connections[i].action == SET)
+      {
+        const Sample* src = sourceChannel(m_connections[i], ch);
+        std::copy(src, src + n, block);
+      }
+    }
+    for (int i = 0; i < m_connections.size(); i++)
+    {
+      if (m_connections[i].action == ADD)
+      {
+        const Sample* src = sourceChannel(m_connections[i], ch);
+        for (int j = 0; j < n; j++)
+        {
+          block[j] += src[j];
+        }
+      }
+    }
+    for (int i = 0; i < m_connections.size(); i++)
+    {
+      if (m_connections[i].action == SCALE)
+      {
+        const Sample* src = sourceChannel(m_connections[i], ch);
+        for (int j = 0; j < n; j++)
+        {
+          block[j] *= src[j];
+        }
+      }
+    }
+    if (m_transform_func)
+    {
+      for (int j = 0; j < n; j++)
+      {
+        block[j] = m_transform_func(block[j]);
+      }
+    }
+    m_channelData[ch] = block;
+  }
+  m_blockData = m_channelData[0];
+  m_blockSize = n;
+  m_isConstant = false;
+}
+
+void syn::UnitParameter::pullBlock(size_t n)
+{
+  if (m_numChannels > 1)
+  {
+    bool hasMultichannelSource = false;
+    for (int i = 0; i < m_connections.size(); i++)
+    {
+      hasMultichannelSource = hasMultichannelSource || m_connections[i].srcchannels > 1;
+    }
+    if (hasMultichannelSource)
+    {
+      pullChannels(n);
+      m_currValue = m_blockData[n - 1];
+      m_needsUpdate = false;
+      return;
+    }
+  }
+  Sample* block = &m_block[0];
+  bool isRamping = m_numChanges > 0 || m_smoothedValue != m_baseValue;
+  bool isZero = false;
+  bool hasConstantSources = true;
+  for (int i = 0; i < m_connections.size(); i++)
+  {
+    if (m_connections[i].action == SCALE && isSilent(m_connections[i]))
+      isZero = true;
+    if (!isConstant(m_connections[i]))
+      hasConstantSources = false;
+  }
+
+  if (!isRamping && (isZero || hasConstantSources))
+  {
+    // fold the sources into a single value, using the same operations as the per-sample path below
+    double value = m_baseValue;
+    for (int i = 0; i < m_connections.size() && !isZero; i++)
+    {
+      if (m_connections[i].action == SET)
+        value = (*m_connections[i].srcbuffer)[0];
+    }
+    for (int i = 0; i < m_connections.size() && !isZero; i++)
+    {
+      if (m_connections[i].action == ADD && !isSilent(m_connections[i]))
+        value += (*m_connections[i].srcbuffer)[0];
+    }
+    for (int i = 0; i < m_connections.size() && !isZero; i++)
+    {
+      if (m_connections[i].action == SCALE)
+        value *= (*m_connections[i].srcbuffer)[0];
+    }
+    if (isZero)
+      value = 0.0;
+    fillBlock(m_transform_func ? m_transform_func(value) : value, n);
+  }
+  else if (!isRamping && !m_transform_func && m_connections.size() == 1 &&
+    (m_connections[0].action == SET || (m_connections[0].action == ADD && m_baseValue == 0)))
+  {
+    // a lone source that would be copied unchanged is read in place
+    m_blockData = &(*m_connections[0].srcbuffer)[0];
+    m_isConstant = false;
+  }
+  else
+  {
+    bool isConstant = !isRamping;
+    if (isRamping)
+      rampBlock(block, n);
+    else
+      std::fill(block, block + n, m_baseValue);
+    for (int i = 0; i < m_connections.size() && !isZero; i++)
+    {
+      if (m_connections[i].action == SET)
+      {
+        if (isSilent(m_connections[i]))
+        {
+          std::fill(block, block + n, 0.0);
+          isConstant = true;
+        }
+        else
+        {
+          const Sample* src = &(*m_connections[i].srcbuffer)[0];
+          std::copy(src, src + n, block);
+          isConstant = false;
+        }
+      }
+    }
+    for (int i = 0; i < m_connections.size() && !isZero; i++)
+    {
+      if (m_connections[i].action == ADD && !isSilent(m_connections[i]))
+      {
+        const Sample* src = &(*m_connections[i].srcbuffer)[0];
+        for (int j = 0; j < n; j++)
+        {
+          block[j] += src[j];
+        }
+        isConstant = false;
+      }
+    }
+    for (int i = 0; i < m_connections.size() && !isZero; i++)
+    {
+      if (m_connections[i].action == SCALE)
+      {
+        const Sample* src = &(*m_connections[i].srcbuffer)[0];
+        for (int j = 0; j < n; j++)
+        {
+          block[j] *= src[j];
+        }
+        isConstant = false;
+      }
+    }
+    if (isZero)
+    {
+      // still ramped above, so that the ramp keeps advancing while the block is muted
+      std::fill(block, block + n, 0.0);
+      isConstant = true;
+    }
+    if (m_transform_func)
+    {
+      for (int j = 0; j < n; j++)
+      {
+        block[j] = m_transform_func(block[j]);
+      }
+    }
+    m_blockData = block;
+    m_blockSize = n;
+    m_isConstant = isConstant;
+  }
+  // with mono sources only, every channel is the same
+  for (int ch = 1; ch < m_numChannels; ch++)
+  {
+    m_channelData[ch] = m_blockData;
+  }
+  m_currValue = m_blockData[n - 1];
+  m_needsUpdate = false;
+}
+
 void syn::UnitParameter::setController(const IControl* controller)
 {
   if (!m_controller)
@@ -57,32 +353,6 @@ void syn::UnitParameter::addValueName(double value, string value_name)
   m_valueNames[value] = value_name;
 }
 
-void syn::UnitParameter::initIParam(IParam* iparam)
-{
-  const char* name = (m_parent->getName() + "-" + m_name).c_str();
-  const char* groupname = m_parent->getName().c_str();
-  const char* label = m_name.c_str();
-  switch (m_type)
-  {
-  case DOUBLE_TYPE:
-    iparam->InitDouble(name, m_baseValue, m_min, m_max, 1e-3, label, groupname);
-    break;
-  case INT_TYPE:
-    iparam->InitInt(name, m_baseValue, m_min, m_max, label, groupname);
-    break;
-  case ENUM_TYPE:
-    iparam->InitEnum(name, m_baseValue, m_max, label, groupname);
-    for (std::pair<int, string> p : m_valueNames)
-    {
-      iparam->SetDisplayText(p.first, p.second.c_str());
-    }
-    break;
-  case BOOL_TYPE:
-    iparam->InitBool(name, m_baseValue, label, groupname);
-    break;
-  }
-}
-
 string syn::UnitParameter::getString() const
 {
   char valueBuf[256];
@@ -1,8 +1,7 @@
 #ifndef __Parameter__
 #define __Parameter__
 
-#include "IControl.h"
-#include "IParam.h"
+#include "Arena.h"
 #include <string>
 #include <vector>
 #include <map>
@@ -11,6 +10,13 @@ using std::string;
 using std::map;
 using std::vector;
 
+#define MAX_PARAM_CHANGES 16 //!< number of timestamped base value changes a parameter can hold for one block
+#define DEFAULT_SMOOTHING_TIME 0.005 //!< ramp time, in seconds, of continuous parameters
+#define SMOOTHING_EPSILON 1e-9 //!< distance to the target below which a one-pole ramp is considered finished
+
+class IControl;
+class IParam;
+
 namespace syn
 {
   enum MOD_ACTION
@@ -21,6 +27,14 @@ namespace syn
     NUM_MOD_ACTIONS
   };
 
+  enum SMOOTHING_MODE
+  {
+    NO_SMOOTHING = 0,
+    LINEAR_SMOOTHING, //!< constant-rate ramp reaching the target after the smoothing time
+    EXP_SMOOTHING, //!< one-pole ramp, with the smoothing time as its time constant
+    NUM_SMOOTHING_MODES
+  };
+
   enum PARAM_TYPE
   {
     DOUBLE_TYPE = 0,
@@ -29,10 +43,30 @@ namespace syn
     ENUM_TYPE
   };
 
+  // Building with SYN_FLOAT_SAMPLES defined processes blocks in single precision. Scalar state that accumulates, such
+  // as oscillator phases, filter states and parameter values, stays in double precision either way.
+#ifdef SYN_FLOAT_SAMPLES
+  typedef float Sample; //!< type of the samples of unit outputs and parameter blocks
+#else
+  typedef double Sample; //!< type of the samples of unit outputs and parameter blocks, see SYN_FLOAT_SAMPLES
+#endif
+  typedef vector<Sample, ArenaAllocator<Sample>> SampleVec; //!< a buffer of samples, allocated from the current Arena if any
+
+  /**
+   * \brief Properties of a unit's last output block, which let the parameters it modulates take shortcuts.
+   */
+  struct BlockFlags
+  {
+    bool isConstant; //!< every sample of each channel of the block holds the same value as the channel's first
+    bool isSilent; //!< every sample of every channel of the block is zero
+  };
+
   struct Connection
   {
-    const vector<double>* srcbuffer;
+    const SampleVec* srcbuffer;
     MOD_ACTION action;
+    const BlockFlags* srcflags; //!< flags of the source's last block, may be null
+    int srcchannels; //!< number of channels stored one after the other in srcbuffer
     bool operator==(const Connection& other) const
     {
       return srcbuffer == other.srcbuffer && action == other.action;
@@ -40,7 +74,7 @@ namespace syn
   };
 
   class Unit;
-  class UnitParameter
+  class UnitParameter : public ArenaAllocated
   {
   protected:
     typedef double(*ParamTransformFunc)(double);
@@ -59,6 +93,25 @@ namespace syn
     map<double, string> m_valueNames;
     vector<Connection> m_connections;
     ParamTransformFunc m_transform_func;
+    SampleVec m_block; //!< modulated value of the parameter for each sample of the current block
+    const Sample* m_blockData; //!< m_block, or the buffer of a source that is passed through unchanged
+    size_t m_blockSize; //!< number of samples of m_block written by the last pullBlock()
+    bool m_isConstant; //!< true when every sample of the block holds the same value
+    int m_numChannels; //!< number of channels computed by pullBlock(), stored one after the other in m_block
+    vector<const Sample*> m_channelData; //!< block of each channel, when the parameter has several
+
+    struct ParamChange
+    {
+      int offset;
+      double value;
+    };
+    ParamChange m_changes[MAX_PARAM_CHANGES]; //!< base value changes scheduled by modAt(), ordered by offset
+    int m_numChanges;
+    SMOOTHING_MODE m_smoothingMode;
+    double m_smoothingTime;
+    double m_smoothedValue; //!< value of the base ramp, which moves towards m_baseValue
+    double m_rampStep; //!< per-sample increment of a linear ramp, or the pole of a one-pole ramp
+    int m_rampRemaining; //!< samples left in a linear ramp
   public:
     UnitParameter(Unit* parent, string name, int id, PARAM_TYPE ptype, double min, double max, double defaultValue, bool ishidden = false) :
       m_parent(parent),
@@ -71,24 +124,50 @@ namespace syn
       m_controller(nullptr),
       m_isHidden(ishidden),
       m_transform_func(nullptr),
-      m_connections(0)
+      m_connections(0),
+      m_block(1, 0.0),
+      m_blockData(&m_block[0]),
+      m_blockSize(0),
+      m_isConstant(false),
+      m_numChannels(1),
+      m_numChanges(0),
+      m_smoothingMode(ptype == DOUBLE_TYPE ? LINEAR_SMOOTHING : NO_SMOOTHING),
+      m_smoothingTime(DEFAULT_SMOOTHING_TIME),
+      m_rampStep(0),
+      m_rampRemaining(0)
     {
       UnitParameter::mod(defaultValue, SET);
       m_currValue = m_baseValue;
+      m_smoothedValue = m_baseValue;
     }
     UnitParameter(const UnitParameter& other) :
       UnitParameter(other.m_parent, other.m_name, other.m_id, other.m_type, other.m_min, other.m_max, other.m_defaultValue)
     {
       UnitParameter::mod(other.m_baseValue, SET);
       setTransformFunc(other.m_transform_func);
+      setSmoothing(other.m_smoothingMode, other.m_smoothingTime);
       m_currValue = m_baseValue;
     }
     virtual ~UnitParameter() {};
 
     bool operator== (const UnitParameter& p) const;
     virtual void mod(double amt, MOD_ACTION action);
+    /**
+     * \brief Schedules a change of the base value at the given sample of the next block processed by pullBlock().
+     *
+     * Unlike mod(), the change is sample accurate and ramps to the new value according to the smoothing settings.
+     * Offsets past the end of the block stay scheduled for the blocks that follow it.
+     */
+    void modAt(double value, int offset);
+    /**
+     * \brief Sets how the parameter ramps to base values scheduled by modAt(). Continuous parameters default to a
+     * DEFAULT_SMOOTHING_TIME linear ramp, and the others to no smoothing.
+     */
+    void setSmoothing(SMOOTHING_MODE mode, double seconds);
+    SMOOTHING_MODE getSmoothingMode() const { return m_smoothingMode; }
+    double getSmoothingTime() const { return m_smoothingTime; }
     void addValueName(double value, string value_name);
-    void initIParam(IParam* iparam);
+    void initIParam(IParam* iparam); //!< defined by the plugin (VOSIMSynth.cpp), as it depends on IPlug
 
     operator double()
     {
@@ -123,9 +202,9 @@ namespace syn
     bool hasController() const { return m_controller != nullptr; }
     void setTransformFunc(ParamTransformFunc func) { m_transform_func = func; }
     bool isHidden() const { return m_isHidden; }
-    void addConnection(const vector<double>* srcbuffer, MOD_ACTION action)
+    void addConnection(const SampleVec* srcbuffer, MOD_ACTION action, const BlockFlags* srcflags = nullptr, int srcchannels = 1)
     {
-      m_connections.push_back({ srcbuffer,action });
+      m_connections.push_back({ srcbuffer,action,srcflags,srcchannels });
     }
     int numConnections() const { return m_connections.size(); }
     void pull(int bufind)
@@ -135,6 +214,52 @@ namespace syn
         mod((*m_connections[i].srcbuffer)[bufind], m_connections[i].action);
       }
     }
+    /**
+     * \brief Computes the modulated value of the parameter for each of the first n samples of the block.
+     *
+     * The value of each sample is the base value (or the last SET source) plus the sum of all ADD sources, times the
+     * product of all SCALE sources, passed through the transform function. The result is accessed via getBlock().
+     *
+     * Sources whose last block is silent are skipped, or zero the block if they scale it. When every source is
+     * constant the value is computed once for the whole block, and a lone source that would be copied unchanged is
+     * read in place.
+     *
+     * A parameter with several channels computes each of them from the same channel of its sources, or from the last
+     * channel of sources that have fewer. Otherwise only the first channel of each source is read.
+     */
+    void pullBlock(size_t n);
+    const Sample* getBlock() const { return m_blockData; }
+    /**
+     * \brief Returns the block of the given channel. The first channel is the one returned by getBlock().
+     */
+    const Sample* getChannel(int c) const { return c == 0 ? m_blockData : m_channelData[c]; }
+    /**
+     * \brief Sets the number of channels computed by pullBlock(). Parameters have a single channel by default, so
+     * that multichannel sources cost mono parameters nothing.
+     */
+    void setNumChannels(int numChannels);
+    int getNumChannels() const { return m_numChannels; }
+    void resizeBlock(size_t n)
+    {
+      m_block.resize(n * m_numChannels);
+      m_blockData = &m_block[0];
+      m_channelData.assign(m_numChannels, m_blockData);
+      m_blockSize = 0;
+      m_isConstant = false;
+    }
+    /**
+     * \brief Returns true if the parameter has the same value over the whole block, e.g. because nothing is connected
+     * to it, or only constant sources are.
+     */
+    bool isConstant() const { return m_isConstant; }
+    /**
+     * \brief Loads the value computed by pullBlock() for the specified sample into the parameter.
+     */
+    void seek(int bufind)
+    {
+      m_currValue = m_blockData[bufind];
+      m_needsUpdate = false;
+    }
     bool isDirty()
     {
       bool isdirty = m_currValue != m_lastValue;
@@ -158,9 +283,33 @@ namespace syn
       other->m_transform_func = m_transform_func;
       other->m_lastValue = m_lastValue;
       other->m_defaultValue = m_defaultValue;
+      other->m_smoothedValue = m_baseValue;
       return other;
     }
   private:
+    static bool isSilent(const Connection& c) { return c.srcflags && c.srcflags->isSilent; }
+    static bool isConstant(const Connection& c) { return c.srcflags && c.srcflags->isConstant; }
+    /**
+     * \brief Returns the start of the block of channel ch of the connection's source.
+     */
+    static const Sample* sourceChannel(const Connection& c, int ch)
+    {
+      ch = ch < c.srcchannels ? ch : c.srcchannels - 1;
+      return &(*c.srcbuffer)[ch * (c.srcbuffer->size() / c.srcchannels)];
+    }
+    /**
+     * \brief Computes each channel of the block, for parameters with several channels and a multichannel source.
+     */
+    void pullChannels(size_t n);
+    /**
+     * \brief Fills the first n samples of m_block with value, unless they already hold it.
+     */
+    void fillBlock(double value, size_t n);
+    void setTarget(double value);
+    /**
+     * \brief Writes the base value of each of the first n samples of the block, applying the scheduled changes.
+     */
+    void rampBlock(Sample* block, size_t n);
     virtual UnitParameter* cloneImpl() const { return new UnitParameter(*this); }
   };
 }
@@ -1,9 +1,12 @@
 #include <stdlib.h>
+#include <algorithm>
 #include "VOSIMSynth.h"
 #include "IPlug_include_in_plug_src.h"
 #include "EnvelopeEditor.h"
 #include "VosimOscillator.h"
 #include "UI.h"
+#include "StandardUnits.h"
+#include "tables.h"
 
 using namespace std;
 
@@ -11,7 +14,9 @@ const int kNumPrograms = 1;
 
 enum EParams
 {
-  kMainVol = 0,
+  kMaxVoices = 0,
+  kOversampling,
+  kNumGlobalParams
 };
 
 enum ELayout
@@ -31,6 +36,15 @@ VOSIMSynth::VOSIMSynth(IPlugInstanceInfo instanceInfo)
   //MakePreset("preset 1", ... );
   //MakeDefaultPreset((char *) "-", kNumPrograms);
 
+  GetParam(kMaxVoices)->InitInt("Voices", 6, 1, MAX_VOICES, "voices");
+  GetParam(kOversampling)->InitEnum("Oversampling", 0, 4);
+  for (int i = 0; (1 << i) <= MAX_OVERSAMPLING; i++)
+  {
+    GetParam(kOversampling)->SetDisplayText(i, (std::to_string(1 << i) + "x").c_str());
+  }
+
+  // build the lookup tables here rather than in the audio callback, where the first oscillator would otherwise do it
+  TableStore::get();
   makeInstrument();
   makeGraphics();
 }
@@ -60,33 +74,69 @@ void VOSIMSynth::makeInstrument()
 {
   m_instr = new Instrument();
   m_unitfactory = new UnitFactory();
-  m_unitfactory->addSourceUnitPrototype(new Envelope("Envelope"));
-  m_unitfactory->addUnitPrototype(new AccumulatingUnit("Accumulator"));
-  m_unitfactory->addSourceUnitPrototype(new VosimOscillator("Osc.VOSIM"));
-  m_unitfactory->addSourceUnitPrototype(new VosimChoir("Osc.VOSIM.Choir"));
-  m_unitfactory->addSourceUnitPrototype(new UniformRandomOscillator("Osc.Random.Normal"));
-  m_unitfactory->addSourceUnitPrototype(new BasicOscillator("Osc.Basic"));
-  m_unitfactory->addSourceUnitPrototype(new LFOOscillator("Osc.LFO"));
+  registerStandardUnits(*m_unitfactory);
 
-  m_voiceManager.setMaxVoices(6, m_instr);
+  m_voiceManager.setMaxVoices(GetParam(kMaxVoices)->Int(), m_instr);
+  m_voiceManager.setNumThreads(int(std::thread::hardware_concurrency()) - 1);
 
   m_MIDIReceiver.noteOn.Connect(&m_voiceManager, &VoiceManager::noteOn);
   m_MIDIReceiver.noteOff.Connect(&m_voiceManager, &VoiceManager::noteOff);
+  m_MIDIReceiver.controlChange.Connect(&m_voiceManager, &VoiceManager::controlChange);
+  m_MIDIReceiver.pitchBend.Connect(&m_voiceManager, &VoiceManager::pitchBend);
+  m_MIDIReceiver.channelPressure.Connect(&m_voiceManager, &VoiceManager::channelPressure);
+  m_MIDIReceiver.polyPressure.Connect(&m_voiceManager, &VoiceManager::polyPressure);
 }
 
 void VOSIMSynth::ProcessDoubleReplacing(double** inputs, double** outputs, int nFrames)
 {
   // Mutex is already locked for us.
-  double *leftOutput = outputs[0];
-  double *rightOutput = outputs[1];
-  memset(leftOutput, 0, nFrames*sizeof(double));
-  for (int s = 0; s < nFrames; s++)
+#ifdef SYN_FLOAT_SAMPLES
+  /*
+   * IPlug passes every host buffer in double precision, so the voices render to a buffer of their own first. It is
+   * sized by Reset() rather than here, where allocating could stall the audio thread, so a block longer than the host
+   * announced is rendered in several passes.
+   */
+  const int passSize = int(m_renderBuffer.size() / 2);
+  if (passSize == 0)
+  { // not reset yet
+    memset(outputs[0], 0, nFrames*sizeof(double));
+    memset(outputs[1], 0, nFrames*sizeof(double));
+    return;
+  }
+#else
+  const int passSize = nFrames;
+#endif
+  int s = 0;
+  while (s < nFrames)
   {
-    m_MIDIReceiver.advance();
-    m_sampleCount++;
+    const int passStart = s;
+    const int passEnd = std::min(passStart + passSize, nFrames);
+#ifdef SYN_FLOAT_SAMPLES
+    Sample *leftOutput = &m_renderBuffer[0];
+    Sample *rightOutput = &m_renderBuffer[passSize];
+#else
+    Sample *leftOutput = outputs[0] + passStart;
+    Sample *rightOutput = outputs[1] + passStart;
+#endif
+    memset(leftOutput, 0, (passEnd - passStart)*sizeof(Sample));
+    memset(rightOutput, 0, (passEnd - passStart)*sizeof(Sample));
+    // render up to each MIDI event, so that notes start and stop on their exact sample
+    while (s < passEnd)
+    {
+      m_MIDIReceiver.advance(s);
+      int next = m_MIDIReceiver.getNextOffset();
+      if (next <= s || next > passEnd)
+        next = passEnd;
+      Sample* blockOutputs[2] = { leftOutput + s - passStart, rightOutput + s - passStart };
+      m_voiceManager.tick(blockOutputs, 2, next - s, s);
+      s = next;
+    }
+#ifdef SYN_FLOAT_SAMPLES
+    std::copy(leftOutput, leftOutput + passEnd - passStart, outputs[0] + passStart);
+    std::copy(rightOutput, rightOutput + passEnd - passStart, outputs[1] + passStart);
+#endif
   }
-  m_voiceManager.tick(leftOutput, nFrames);
-  memcpy(rightOutput, leftOutput, nFrames*sizeof(double));
+  m_sampleCount += nFrames;
   m_Oscilloscope->process();
   m_MIDIReceiver.Flush(nFrames);
 }
@@ -122,6 +172,13 @@ int VOSIMSynth::UnserializeState(ByteChunk* pChunk, int startPos)
 {
   IMutexLock lock(this);
   startPos = m_circuitPanel->unserialize(pChunk, startPos);
+  // the patch sets the oversampling factor, so update the parameter reflecting it
+  int oversampling = 0;
+  while ((2 << oversampling) <= m_voiceManager.getOversampling())
+  {
+    oversampling++;
+  }
+  GetParam(kOversampling)->Set(oversampling);
   return startPos;
 }
 
@@ -138,16 +195,65 @@ void VOSIMSynth::Reset()
   m_MIDIReceiver.Resize(GetBlockSize());
   m_voiceManager.setBufSize(GetBlockSize());
   m_voiceManager.setFs(fs);
+#ifdef SYN_FLOAT_SAMPLES
+  m_renderBuffer.resize(2 * GetBlockSize());
+#endif
 }
 
 void VOSIMSynth::OnParamChange(int paramIdx)
 {
-  IMutexLock lock(this);
-  if (paramIdx < m_hostParamMap.size())
+  if (paramIdx == kMaxVoices)
+  {
+    // the voices are rebuilt without holding the audio thread, and keep playing their notes
+    if (GetParam(kMaxVoices)->Int() != m_voiceManager.getMaxVoices())
+      m_voiceManager.resizeVoices(GetParam(kMaxVoices)->Int());
+  }
+  else if (paramIdx == kOversampling)
   {
-    int uid = m_hostParamMap[paramIdx].first;
-    int pid = m_hostParamMap[paramIdx].second;
-    m_voiceManager.modifyParameter(uid, pid, GetParam(paramIdx)->Value(), SET);
-    InformHostOfParamChange(paramIdx, GetParam(paramIdx)->Value());
+    // like the voice count, applied through rebuilt voices rather than under the audio lock
+    m_voiceManager.setOversampling(1 << GetParam(kOversampling)->Int());
   }
-}
\ No newline at end of file
+  else if (paramIdx - kNumGlobalParams < m_hostParamMap.size())
+  {
+    int uid = m_hostParamMap[paramIdx - kNumGlobalParams].first;
+    int pid = m_hostParamMap[paramIdx - kNumGlobalParams].second;
+    double value = GetParam(paramIdx)->Value();
+    /*
+     * IPlug reports automation without the sample it belongs to, so the change takes effect at the start of the next
+     * block. Sample accurate offsets are only reachable by calling queueParameter() directly.
+     */
+    if (!m_voiceManager.queueParameter(uid, pid, value))
+    { // the audio thread has fallen behind, so drain the queue on its behalf
+      IMutexLock lock(this);
+      m_voiceManager.flushParameterQueue();
+      m_voiceManager.queueParameter(uid, pid, value);
+    }
+    InformHostOfParamChange(paramIdx, value);
+  }
+}
+
+void UnitParameter::initIParam(IParam* iparam)
+{
+  const char* name = (m_parent->getName() + "-" + m_name).c_str();
+  const char* groupname = m_parent->getName().c_str();
+  const char* label = m_name.c_str();
+  switch (m_type)
+  {
+  case DOUBLE_TYPE:
+    iparam->InitDouble(name, m_baseValue, m_min, m_max, 1e-3, label, groupname);
+    break;
+  case INT_TYPE:
+    iparam->InitInt(name, m_baseValue, m_min, m_max, label, groupname);
+    break;
+  case ENUM_TYPE:
+    iparam->InitEnum(name, m_baseValue, m_max, label, groupname);
+    for (std::pair<int, string> p : m_valueNames)
+    {
+      iparam->SetDisplayText(p.first, p.second.c_str());
+    }
+    break;
+  case BOOL_TYPE:
+    iparam->InitBool(name, m_baseValue, label, groupname);
+    break;
+  }
+}
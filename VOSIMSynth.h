@@ -42,11 +42,14 @@ private:
   Instrument* m_instr;
   UnitFactory* m_unitfactory;
 
-  vector<pair<int, int>> m_hostParamMap;
+  vector<pair<int, int>> m_hostParamMap; //!< (unit id, param id) of each host parameter following the global ones
   unordered_map<int, unordered_map<int, int>> m_invHostParamMap;
   IGraphics* pGraphics;
   int m_numParameters;
   unsigned int m_sampleCount;
+#ifdef SYN_FLOAT_SAMPLES
+  vector<Sample> m_renderBuffer; //!< left then right output of the voices, converted to the host's buffers
+#endif
 };
 
 #endif
@@ -1,17 +1,45 @@
 #include "VoiceManager.h"
+#include <algorithm>
+#include <cmath>
 namespace syn
 {
-  int VoiceManager::createVoice(int note, int vel)
+  VoiceSet::~VoiceSet()
+  {
+    // the voices' objects must be destroyed before the arenas holding them
+    for (int i = 0; i < voices.size(); i++)
+    {
+      delete voices[i];
+    }
+    for (int i = 0; i < arenas.size(); i++)
+    {
+      delete arenas[i];
+    }
+  }
+
+  int VoiceManager::createVoice(int note, int vel, int channel)
   {
     int vind = findIdleVoice();
-    m_idleVoiceStack.remove(vind);
-    m_voiceStack.push_back(vind);
-    m_voiceMap[note].push_back(vind);
-    m_allVoices[vind]->noteOn(note, vel);
+    startVoice(vind, note, vel, channel);
     m_numVoices++;
     return vind;
   }
 
+  void VoiceManager::startVoice(int vind, int note, int vel, int channel)
+  {
+    m_voiceStack.push_back(vind);
+    m_voiceMap.push_back(vind, note);
+    m_channelMap.push_back(vind, channel);
+    m_voiceChannel[vind] = channel;
+    m_voiceVelocity[vind] = vel;
+    m_voiceReleased[vind] = false;
+    m_voiceSustained[vind] = false;
+    m_voicePressure[vind] = 0;
+    m_voiceSilentSamples[vind] = 0;
+    if (isMpeEnabled())
+      sendChannelControls(vind);
+    m_allVoices[vind]->noteOn(note, vel);
+  }
+
   void VoiceManager::makeIdle()
   {
     if (m_numVoices > 0) {
@@ -22,74 +50,534 @@ namespace syn
 
   void VoiceManager::makeIdle(int vind)
   {
-    if (m_numVoices > 0) {
-      if(m_voiceMap.find(m_allVoices[vind]->getNote())!=m_voiceMap.end()){
-        m_voiceMap[m_allVoices[vind]->getNote()].remove(vind);     
-        if (m_voiceMap[m_allVoices[vind]->getNote()].empty())
-        {
-          m_voiceMap.erase(m_allVoices[vind]->getNote());
-        }
-        m_voiceStack.remove(vind);
-        m_onDyingVoice.Emit(m_allVoices[vind]);
-        m_idleVoiceStack.push_front(vind);
-        m_numVoices--;
-      }
+    if (m_numVoices > 0 && m_voiceStack.contains(vind)) {
+      m_voiceMap.remove(vind);
+      m_channelMap.remove(vind);
+      m_voiceStack.remove(vind);
+      m_onDyingVoice.Emit(m_allVoices[vind]);
+      m_idleVoiceStack.push_front(vind);
+      m_numVoices--;
     }
   }
 
   int VoiceManager::findIdleVoice()
   {
-    int vind = m_idleVoiceStack.front();
-    m_idleVoiceStack.pop_front();
-    return vind;
+    return m_idleVoiceStack.pop_front();
   }
 
-  void VoiceManager::noteOn(uint8_t noteNumber, uint8_t velocity)
+  void VoiceManager::noteOn(uint8_t noteNumber, uint8_t velocity, uint8_t channel)
   {
-    if (m_numVoices == m_maxVoices - 1)
+    noteNumber &= NUM_MIDI_NOTES - 1;
+    channel &= NUM_MIDI_CHANNELS - 1;
+    if (m_idleVoiceStack.empty())
+    { // steal the oldest voice
+      int vind = m_voiceStack.front();
+      if (vind == m_voiceStack.end())
+        return;
+      startVoice(vind, noteNumber, velocity, channel);
+    }
+    else
     {
-      Instrument* v;
-      int vind = getOldestVoiceInd();
-      m_idleVoiceStack.remove(vind);
-      v = m_allVoices[vind];
-      m_voiceMap[v->getNote()].remove(vind);
-      m_voiceStack.remove(vind);
-      v->noteOn(noteNumber, velocity);
-      m_voiceStack.push_back(vind);
-      m_voiceMap[noteNumber].push_back(vind);
+      createVoice(noteNumber, velocity, channel);
     }
-    else if (m_numVoices >= 0)
+  }
+
+  void VoiceManager::noteOff(uint8_t noteNumber, uint8_t velocity, uint8_t channel)
+  {
+    noteNumber &= NUM_MIDI_NOTES - 1;
+    channel &= NUM_MIDI_CHANNELS - 1;
+    if (isMpeEnabled())
+    { // only release the note on the channel it was started on
+      for (int v = m_channelMap.front(channel); v != m_channelMap.end(channel); v = m_channelMap.next(v))
+      {
+        if (m_voiceMap.contains(v, noteNumber))
+          releaseVoice(v, velocity);
+      }
+    }
+    else
     {
-      createVoice(noteNumber, velocity);
+      for (int v = m_voiceMap.front(noteNumber); v != m_voiceMap.end(noteNumber); v = m_voiceMap.next(v))
+      {
+        releaseVoice(v, velocity);
+      }
     }
   }
 
-  void VoiceManager::noteOff(uint8_t noteNumber, uint8_t velocity)
+  void VoiceManager::releaseVoice(int vind, uint8_t velocity)
   {
-    if (m_voiceMap.find(noteNumber) != m_voiceMap.end() && !m_voiceMap[noteNumber].empty())
+    if (m_isSustained)
     {
-      for (VoiceList::iterator v = m_voiceMap[noteNumber].begin(); v != m_voiceMap[noteNumber].end(); v++)
+      m_voiceSustained[vind] = true;
+      return;
+    }
+    m_voiceReleased[vind] = true;
+    m_allVoices[vind]->noteOff(m_allVoices[vind]->getNote(), velocity);
+  }
+
+  void VoiceManager::releaseSustainedVoices()
+  {
+    for (int v = m_voiceStack.front(); v != m_voiceStack.end(); v = m_voiceStack.next(v))
+    {
+      if (m_voiceSustained[v])
       {
-        m_allVoices[*v]->noteOff(noteNumber, velocity);
+        m_voiceSustained[v] = false;
+        m_voiceReleased[v] = true;
+        m_allVoices[v]->noteOff(m_allVoices[v]->getNote(), 0);
       }
     }
   }
 
+  void VoiceManager::sendMidiControl(MIDI_CONTROL control, int num, double value)
+  {
+    // idle voices are updated too, so that they start with the current controller values
+    for (int i = 0; i < m_allVoices.size(); i++)
+    {
+      m_allVoices[i]->setMidiControl(control, num, value);
+    }
+  }
+
+  void VoiceManager::sendChannelControls(int vind)
+  {
+    int channel = m_voiceChannel[vind];
+    Instrument* voice = m_allVoices[vind];
+    voice->setMidiControl(PITCH_BEND, 0, m_pitchBend + m_channelBend[channel]);
+    voice->setMidiControl(CHANNEL_PRESSURE, 0, m_channelPressure + m_memberPressure[channel]);
+    voice->setMidiControl(CONTROL_CHANGE, MIDI_CC_TIMBRE,
+                          isMpeMemberChannel(channel) ? m_channelTimbre[channel] : m_controls[MIDI_CC_TIMBRE]);
+  }
+
+  void VoiceManager::sendToChannel(int channel, MIDI_CONTROL control, int num, double value)
+  {
+    for (int v = m_channelMap.front(channel); v != m_channelMap.end(channel); v = m_channelMap.next(v))
+    {
+      m_allVoices[v]->setMidiControl(control, num, value);
+    }
+  }
+
+  void VoiceManager::restoreMidiControls()
+  {
+    sendMidiControl(PITCH_BEND, 0, m_pitchBend);
+    sendMidiControl(CHANNEL_PRESSURE, 0, m_channelPressure);
+    for (int cc = 0; cc < NUM_MIDI_CCS; cc++)
+    {
+      if (m_controls[cc] != 0)
+        sendMidiControl(CONTROL_CHANGE, cc, m_controls[cc]);
+    }
+    if (isMpeEnabled())
+    {
+      for (int v = m_voiceStack.front(); v != m_voiceStack.end(); v = m_voiceStack.next(v))
+      {
+        sendChannelControls(v);
+      }
+    }
+  }
+
+  void VoiceManager::pitchBend(double value, uint8_t channel)
+  {
+    channel &= NUM_MIDI_CHANNELS - 1;
+    if (isMpeMemberChannel(channel))
+    {
+      m_channelBend[channel] = value;
+      sendToChannel(channel, PITCH_BEND, 0, m_pitchBend + value);
+      return;
+    }
+    m_pitchBend = value;
+    if (!isMpeEnabled())
+    {
+      sendMidiControl(PITCH_BEND, 0, value);
+      return;
+    }
+    for (int i = 0; i < m_allVoices.size(); i++)
+    {
+      m_allVoices[i]->setMidiControl(PITCH_BEND, 0, value + m_channelBend[m_voiceChannel[i]]);
+    }
+  }
+
+  void VoiceManager::controlChange(uint8_t cc, uint8_t value, uint8_t channel)
+  {
+    cc &= NUM_MIDI_CCS - 1;
+    channel &= NUM_MIDI_CHANNELS - 1;
+    updateRpn(cc, value, channel);
+    if (isMpeMemberChannel(channel))
+    {
+      if (cc == MIDI_CC_TIMBRE)
+        m_channelTimbre[channel] = value / 127.0;
+      sendToChannel(channel, CONTROL_CHANGE, cc, value / 127.0);
+      return;
+    }
+    m_controls[cc] = value / 127.0;
+    sendMidiControl(CONTROL_CHANGE, cc, m_controls[cc]);
+    if (cc == MIDI_CC_SUSTAIN)
+    {
+      bool isSustained = value >= 64;
+      if (m_isSustained && !isSustained)
+        releaseSustainedVoices();
+      m_isSustained = isSustained;
+    }
+  }
+
+  void VoiceManager::updateRpn(uint8_t cc, uint8_t value, uint8_t channel)
+  {
+    switch (cc)
+    {
+    case MIDI_CC_RPN_MSB:
+      m_rpn[channel] = (value << 7) | (m_rpn[channel] & 0x7F);
+      break;
+    case MIDI_CC_RPN_LSB:
+      m_rpn[channel] = (m_rpn[channel] & ~0x7F) | value;
+      break;
+    case MIDI_CC_DATA_ENTRY:
+      // MPE configuration message, sent on the manager channel of the zone
+      if (m_rpn[channel] == MIDI_RPN_MPE_CONFIG && (channel == 0 || channel == NUM_MIDI_CHANNELS - 1))
+        setMpeZone(channel != 0, value);
+      break;
+    default:
+      break;
+    }
+  }
+
+  void VoiceManager::setMpeZone(bool upper, int numChannels)
+  {
+    numChannels = std::min(std::max(numChannels, 0), NUM_MIDI_CHANNELS - 1);
+    // a zone that overlaps the new one shrinks to make room for it
+    int* zone = upper ? &m_upperZoneSize : &m_lowerZoneSize;
+    int* other = upper ? &m_lowerZoneSize : &m_upperZoneSize;
+    *zone = numChannels;
+    if (*other > NUM_MIDI_CHANNELS - 2 - numChannels)
+      *other = std::max(NUM_MIDI_CHANNELS - 2 - numChannels, 0);
+    for (int ch = 0; ch < NUM_MIDI_CHANNELS; ch++)
+    {
+      m_channelBend[ch] = 0;
+      m_memberPressure[ch] = 0;
+      m_channelTimbre[ch] = 0;
+    }
+  }
+
+  bool VoiceManager::isMpeMemberChannel(int channel) const
+  {
+    return (channel >= 1 && channel <= m_lowerZoneSize) ||
+      (channel < NUM_MIDI_CHANNELS - 1 && channel >= NUM_MIDI_CHANNELS - 1 - m_upperZoneSize);
+  }
+
+  void VoiceManager::channelPressure(uint8_t value, uint8_t channel)
+  {
+    channel &= NUM_MIDI_CHANNELS - 1;
+    if (isMpeMemberChannel(channel))
+    {
+      m_memberPressure[channel] = value / 127.0;
+      sendToChannel(channel, CHANNEL_PRESSURE, 0, m_channelPressure + m_memberPressure[channel]);
+      return;
+    }
+    m_channelPressure = value / 127.0;
+    if (!isMpeEnabled())
+    {
+      sendMidiControl(CHANNEL_PRESSURE, 0, m_channelPressure);
+      return;
+    }
+    for (int i = 0; i < m_allVoices.size(); i++)
+    {
+      m_allVoices[i]->setMidiControl(CHANNEL_PRESSURE, 0, m_channelPressure + m_memberPressure[m_voiceChannel[i]]);
+    }
+  }
+
+  void VoiceManager::polyPressure(uint8_t noteNumber, uint8_t value, uint8_t channel)
+  {
+    noteNumber &= NUM_MIDI_NOTES - 1;
+    channel &= NUM_MIDI_CHANNELS - 1;
+    for (int v = m_voiceMap.front(noteNumber); v != m_voiceMap.end(noteNumber); v = m_voiceMap.next(v))
+    {
+      if (isMpeEnabled() && m_voiceChannel[v] != channel)
+        continue;
+      m_voicePressure[v] = value / 127.0;
+      m_allVoices[v]->setMidiControl(POLY_PRESSURE, 0, m_voicePressure[v]);
+    }
+  }
+
   void VoiceManager::setFs(double fs)
   {
-    m_instrument->setFs(fs);
+    {
+      std::unique_lock<std::mutex> protoLock(m_protoMutex);
+      m_Fs = fs;
+      m_instrument->setFs(fs * m_instrument->getOversampling());
+      // a set cloned at the previous rate may be waiting to be swapped in
+      VoiceSet* pending = m_pendingVoices.load(std::memory_order_acquire);
+      for (int i = 0; pending && i < pending->voices.size(); i++)
+      {
+        pending->voices[i]->setFs(fs * pending->oversampling);
+      }
+      releasePrototype(protoLock);
+    }
     for (vector<Instrument*>::iterator v = m_allVoices.begin(); v != m_allVoices.end(); v++)
     {
-      (*v)->setFs(fs);
+      (*v)->setFs(fs * m_oversampling);
     }
   }
 
   void VoiceManager::setBufSize(size_t bufsize)
   {
+    {
+      std::unique_lock<std::mutex> protoLock(m_protoMutex);
+      m_bufSize = bufsize;
+      // a set cloned at the previous size may be waiting to be swapped in
+      VoiceSet* pending = m_pendingVoices.load(std::memory_order_acquire);
+      for (int i = 0; pending && i < pending->voices.size(); i++)
+      {
+        // resized from the heap, like in resizeBuffers()
+        if (pending->voices[i]->getBufSize() != bufsize * pending->oversampling)
+          pending->voices[i]->setBufSize(bufsize * pending->oversampling);
+      }
+      releasePrototype(protoLock);
+    }
+    resizeBuffers(bufsize);
+  }
+
+  void VoiceManager::resizeBuffers(size_t bufsize)
+  {
+    m_bufSize = bufsize;
+    size_t voicebufsize = bufsize * m_oversampling;
+    /*
+     * The resized buffers come from the heap rather than the voices' arenas. An arena never reclaims the buffers they
+     * replace, so every resize would grow it for as long as the voice lives; heap buffers are freed by the next
+     * resize, and voice sets cloned afterwards are laid out in their arenas at the new size again.
+     */
+    for (int i = 0; i < m_allVoices.size(); i++)
+    {
+      if (m_allVoices[i]->getBufSize() != voicebufsize)
+      {
+        m_allVoices[i]->setBufSize(voicebufsize);
+      }
+    }
+    // voice sets rebuilt at another oversampling factor are swapped in by the audio thread, so the buffers that
+    // tick() mixes and decimates them in are sized for any factor
+    for (int c = 0; c < MAX_OUTPUT_CHANNELS; c++)
+    {
+      m_mixBuffers[c].resize(bufsize * MAX_OVERSAMPLING);
+      for (int i = 0; i < m_decimators[c].size(); i++)
+      {
+        m_decimators[c][i].resize(bufsize * MAX_OVERSAMPLING);
+      }
+    }
+  }
+
+  int VoiceManager::roundOversampling(int factor)
+  {
+    int oversampling = 1;
+    while (oversampling * 2 <= std::min(factor, MAX_OVERSAMPLING))
+    {
+      oversampling *= 2;
+    }
+    return oversampling;
+  }
+
+  void VoiceManager::setOversampling(int factor)
+  {
+    int oversampling = roundOversampling(factor);
+    bool changed;
+    {
+      std::unique_lock<std::mutex> protoLock(m_protoMutex);
+      changed = oversampling != m_instrument->getOversampling();
+      m_instrument->setOversampling(oversampling);
+      m_instrument->setFs(m_Fs * oversampling);
+      releasePrototype(protoLock);
+    }
+    // the audio thread switches to the new rate along with the voices, see swapInPendingVoices()
+    if (changed)
+      rebuildVoices();
+  }
+
+  void VoiceManager::resetDecimators()
+  {
+    for (int c = 0; c < MAX_OUTPUT_CHANNELS; c++)
+    {
+      for (int i = 0; i < m_decimators[c].size(); i++)
+      {
+        m_decimators[c][i].reset();
+      }
+    }
+  }
+
+  void VoiceManager::rebuildVoice(int vind)
+  {
+    destroyVoice(vind);
+    cloneVoice(m_allVoices[vind], m_voiceArenas[vind]);
+  }
+
+  void VoiceManager::cloneVoice(Instrument*& voice, Arena*& arena) const
+  {
+    arena = new Arena();
+    Arena::Scope scope(arena);
+    voice = static_cast<Instrument*>(m_instrument->clone());
+    // the prototype's factor, which the voices being rendered may not have switched to yet
+    size_t voicebufsize = m_bufSize * m_instrument->getOversampling();
+    if (voice->getBufSize() != voicebufsize)
+      voice->setBufSize(voicebufsize);
+  }
+
+  void VoiceManager::rebuildVoices()
+  {
+    collectRetiredVoices();
+    /*
+     * Parameter changes queued while the set is built may reach the old voices before the swap, so their prototype
+     * updates are deferred to this thread, which applies them to the set too before publishing it.
+     */
+    std::unique_lock<std::mutex> protoLock(m_protoMutex);
+    VoiceSet* voices = new VoiceSet();
+    int numVoices = m_maxVoices;
+    voices->oversampling = m_instrument->getOversampling();
+    voices->voices.resize(numVoices, nullptr);
+    voices->arenas.resize(numVoices, nullptr);
+    for (int i = 0; i < numVoices; i++)
+    {
+      cloneVoice(voices->voices[i], voices->arenas[i]);
+    }
+    std::lock_guard<std::mutex> queueLock(m_queueMutex);
+    // changes queued during cloning may have been applied to the old voices already, so the set gets them here
+    applyDeferredParameters(voices);
+    protoLock.unlock();
+    // a set the audio thread has not picked up yet is out of date, and was never seen by it
+    delete m_pendingVoices.exchange(voices, std::memory_order_acq_rel);
+  }
+
+  void VoiceManager::resizeVoices(int max)
+  {
+    m_maxVoices = std::min(std::max(max, 1), MAX_VOICES);
+    rebuildVoices();
+  }
+
+  void VoiceManager::releasePrototype(std::unique_lock<std::mutex>& protoLock)
+  {
+    std::lock_guard<std::mutex> queueLock(m_queueMutex);
+    // a pending set was published before these changes were queued, so it receives them from tick()
+    applyDeferredParameters(nullptr);
+    protoLock.unlock();
+  }
+
+  void VoiceManager::applyDeferredParameters(VoiceSet* voices)
+  {
+    for (int i = 0; i < m_numDeferredParams; i++)
+    {
+      const ParamEvent& event = m_deferredParams[i];
+      // the unit may have been removed since, like in flushParameterQueue()
+      if (!m_instrument->hasUnit(event.uid) || event.pid < 0 || event.pid >= m_instrument->getUnit(event.uid).getNumParameters())
+        continue;
+      m_instrument->modifyParameter(event.uid, event.pid, event.value, SET);
+      for (int v = 0; voices && v < voices->voices.size(); v++)
+      {
+        voices->voices[v]->modifyParameter(event.uid, event.pid, event.value, SET);
+      }
+    }
+    m_numDeferredParams = 0;
+  }
+
+  void VoiceManager::swapInPendingVoices()
+  {
+    VoiceSet* voices = m_pendingVoices.exchange(nullptr, std::memory_order_acquire);
+    if (!voices)
+      return;
+    int size = int(voices->voices.size());
+    if (size != m_allVoices.size())
+    {
+      // the oldest notes that do not fit in a smaller set are dropped, and the others move to voices that it has
+      while (m_voiceStack.size() > size)
+      {
+        makeIdle(m_voiceStack.front());
+      }
+      int free = 0;
+      for (int v = m_voiceStack.front(); v != m_voiceStack.end();)
+      {
+        int next = m_voiceStack.next(v);
+        if (v >= size)
+        {
+          while (m_voiceStack.contains(free))
+            free++;
+          moveVoice(v, free);
+        }
+        v = next;
+      }
+      m_idleVoiceStack.clear();
+      for (int i = 0; i < size; i++)
+      {
+        if (!m_voiceStack.contains(i))
+          m_idleVoiceStack.push_back(i);
+      }
+    }
+    if (voices->oversampling != m_oversampling)
+    {
+      m_oversampling = voices->oversampling;
+      resetDecimators();
+    }
+    m_allVoices.swap(voices->voices);
+    m_voiceArenas.swap(voices->arenas);
+    restoreMidiControls();
+    for (int v = m_voiceStack.front(); v != m_voiceStack.end(); v = m_voiceStack.next(v))
+    {
+      /*
+       * The note is restarted so that units added by the edit start playing it, then the units that survived the
+       * edit take over the state of their old copies: envelopes keep their segment, released voices keep their tail
+       * and oscillators keep their phase.
+       */
+      int note = voices->voices[v]->getNote();
+      m_allVoices[v]->noteOn(note, m_voiceVelocity[v]);
+      if (m_voiceReleased[v])
+        m_allVoices[v]->noteOff(note, 0);
+      m_allVoices[v]->copyState(*voices->voices[v]);
+      m_allVoices[v]->setMidiControl(POLY_PRESSURE, 0, m_voicePressure[v]);
+    }
+    // freeing memory is not real-time safe, so the old voices are reclaimed by the next rebuildVoices() call
+    retireVoices(voices);
+  }
+
+  void VoiceManager::moveVoice(int from, int to)
+  {
+    m_voiceStack.replace(from, to);
+    m_voiceMap.replace(from, to);
+    m_channelMap.replace(from, to);
+    m_voiceChannel[to] = m_voiceChannel[from];
+    m_voiceVelocity[to] = m_voiceVelocity[from];
+    m_voiceReleased[to] = m_voiceReleased[from];
+    m_voiceSustained[to] = m_voiceSustained[from];
+    m_voicePressure[to] = m_voicePressure[from];
+    m_voiceSilentSamples[to] = m_voiceSilentSamples[from];
+    // the old voice goes along, so that the new one at its place takes over its state
+    std::swap(m_allVoices[from], m_allVoices[to]);
+    std::swap(m_voiceArenas[from], m_voiceArenas[to]);
+  }
+
+  void VoiceManager::retireVoices(VoiceSet* voices)
+  {
+    voices->next = m_retiredVoices.load(std::memory_order_relaxed);
+    while (!m_retiredVoices.compare_exchange_weak(voices->next, voices, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+  }
+
+  void VoiceManager::collectRetiredVoices()
+  {
+    VoiceSet* voices = m_retiredVoices.exchange(nullptr, std::memory_order_acquire);
+    while (voices)
+    {
+      VoiceSet* next = voices->next;
+      delete voices;
+      voices = next;
+    }
+  }
+
+  void VoiceManager::destroyVoice(int vind)
+  {
+    // the voice's objects must be destroyed before the arena holding them
+    delete m_allVoices[vind];
+    delete m_voiceArenas[vind];
+    m_allVoices[vind] = nullptr;
+    m_voiceArenas[vind] = nullptr;
+  }
+
+  VoiceManager::~VoiceManager()
+  {
+    delete m_pendingVoices.exchange(nullptr);
+    collectRetiredVoices();
     for (int i = 0; i < m_allVoices.size(); i++)
     {
-      if (m_allVoices[i]->getBufSize() != bufsize)
-        m_allVoices[i]->setBufSize(bufsize);
+      destroyVoice(i);
     }
   }
 
@@ -97,67 +585,179 @@ namespace syn
   {
     if (max < 1)
       max = 1;
+    if (max > MAX_VOICES)
+      max = MAX_VOICES;
     m_maxVoices = max;
-    while (m_voiceStack.size() > 0)
+    // the voices are rebuilt below from the latest prototype anyway
+    delete m_pendingVoices.exchange(nullptr, std::memory_order_acq_rel);
+    while (!m_voiceStack.empty())
     {
-      makeIdle();
-      m_idleVoiceStack.pop_front();
-    }
-
-    while (m_idleVoiceStack.size() > 0)
-    {
-      m_idleVoiceStack.pop_back();
+      makeIdle(m_voiceStack.front());
     }
+    m_voiceMap.clear();
+    m_channelMap.clear();
+    m_voiceStack.clear();
+    m_idleVoiceStack.clear();
 
     while (m_allVoices.size() > max)
     {
-      delete m_allVoices.back();
+      destroyVoice(m_allVoices.size() - 1);
       m_allVoices.pop_back();
+      m_voiceArenas.pop_back();
     }
 
     m_instrument = v;
+    m_oversampling = roundOversampling(v->getOversampling());
+    m_instrument->setOversampling(m_oversampling);
+    m_instrument->setFs(m_Fs * m_oversampling);
+    resetDecimators();
+    // resizeVoices() may add voices from the audio thread, where these must not grow
+    m_renderList.reserve(MAX_VOICES);
+    m_garbageList.reserve(MAX_VOICES);
 
+    m_allVoices.resize(max, nullptr);
+    m_voiceArenas.resize(max, nullptr);
     for (int i = 0; i < m_allVoices.size(); i++)
     {
-      delete m_allVoices[i];
-      m_allVoices[i] = static_cast<Instrument*>(m_instrument->clone());
-      m_idleVoiceStack.push_back(i);
+      rebuildVoice(i);
     }
+    restoreMidiControls();
 
-    while (m_allVoices.size() < max)
+    for (int i = 0; i < m_allVoices.size(); i++)
     {
-      m_allVoices.push_back(static_cast<Instrument*>(m_instrument->clone()));
-      m_idleVoiceStack.push_back(m_allVoices.size()-1);
+      m_idleVoiceStack.push_back(i);
     }
     m_numVoices = 0;
   }
 
-  void VoiceManager::tick(double* buf, size_t bufsize)
+  void VoiceManager::renderVoice(void* vm, int renderind)
+  {
+    VoiceManager* self = static_cast<VoiceManager*>(vm);
+    self->m_allVoices[self->m_renderList[renderind]]->tick(self->m_tickSize);
+  }
+
+  void VoiceManager::tick(Sample** bufs, int numChannels, size_t bufsize, size_t blockOffset)
   {
-    vector<int> garbage_list;
-    for (VoiceList::const_iterator v = m_voiceStack.begin(); v != m_voiceStack.end(); v++)
+    swapInPendingVoices();
+    flushParameterQueue(blockOffset);
+    // the voices run at m_oversampling times the output rate
+    m_tickSize = bufsize * m_oversampling;
+    m_renderList.clear();
+    m_garbageList.clear();
+    for (int v = m_voiceStack.front(); v != m_voiceStack.end(); v = m_voiceStack.next(v))
     {
-      Instrument* voice = m_allVoices[*v];
+      Instrument* voice = m_allVoices[v];
       if (voice->isActive())
       {
-        if (voice->getBufSize() != bufsize)
+        if (voice->getBufSize() < m_tickSize)
         {
-          setBufSize(bufsize);
+          resizeBuffers(bufsize);
         }
-        voice->tick();
-        const vector<double>& voicebuf = voice->getLastOutputBuffer();
-        for (int i = 0; i < voice->getBufSize(); i++) {
-          buf[i] += voicebuf[i];
+        m_renderList.push_back(v);
+      }
+      else
+      {
+        m_garbageList.push_back(v);
+      }
+    }
+
+    if (m_renderList.size() >= m_minParallelVoices)
+    {
+      m_workerPool.run(&VoiceManager::renderVoice, this, m_renderList.size());
+    }
+    else
+    {
+      // too few voices to render them in parallel, so let each voice spread its own work over the pool instead
+      WorkerPool* pool = m_workerPool.getNumThreads() > 0 ? &m_workerPool : nullptr;
+      for (int i = 0; i < m_renderList.size(); i++)
+      {
+        m_allVoices[m_renderList[i]]->tick(m_tickSize, pool);
+      }
+    }
+
+    // every voice is a clone of the same instrument, so they all have the same number of channels
+    int mixChannels = 1;
+    if (!m_renderList.empty())
+    {
+      mixChannels = std::min(m_allVoices[m_renderList[0]]->getNumChannels(), MAX_OUTPUT_CHANNELS);
+    }
+    mixChannels = std::min(mixChannels, numChannels);
+    // voices are mixed straight into the output, unless it must be decimated or copied to other channels first
+    bool useMixBuffers = m_oversampling > 1 || numChannels > mixChannels;
+    Sample* mix[MAX_OUTPUT_CHANNELS];
+    for (int c = 0; c < mixChannels; c++)
+    {
+      mix[c] = bufs[c];
+      if (useMixBuffers)
+      {
+        mix[c] = &m_mixBuffers[c][0];
+        std::fill(mix[c], mix[c] + m_tickSize, 0.0);
+      }
+    }
+
+    const size_t holdsamples = static_cast<size_t>(SILENCE_HOLD_TIME * m_Fs * m_oversampling);
+    for (int i = 0; i < m_renderList.size(); i++)
+    {
+      int v = m_renderList[i];
+      Sample peak = 0;
+      for (int c = 0; c < mixChannels; c++)
+      {
+        const Sample* voicebuf = m_allVoices[v]->getOutputChannel(c);
+        Sample* mixbuf = mix[c];
+        for (int j = 0; j < m_tickSize; j++) {
+          mixbuf[j] += voicebuf[j];
+          peak = std::max(peak, std::abs(voicebuf[j]));
+        }
+      }
+      // released voices whose envelopes never reach zero (or decay very slowly) would otherwise render forever
+      if (peak < SILENCE_THRESHOLD)
+      {
+        m_voiceSilentSamples[v] += m_tickSize;
+        if (m_voiceReleased[v] && m_voiceSilentSamples[v] >= holdsamples)
+        {
+          m_garbageList.push_back(v);
         }
       }
       else
       {
-        garbage_list.push_back(*v);
+        m_voiceSilentSamples[v] = 0;
       }
     }
-    for (int i = 0; i < garbage_list.size(); i++)
+
+    if (m_oversampling > 1)
+    {
+      // decimate the mix back to the output rate, one octave per stage
+      int firststage = NUM_DECIMATION_STAGES;
+      for (int factor = m_oversampling; factor > 1; factor /= 2)
+      {
+        firststage--;
+      }
+      for (int c = 0; c < mixChannels; c++)
+      {
+        size_t n = m_tickSize;
+        for (int stage = firststage; stage < NUM_DECIMATION_STAGES; stage++)
+        {
+          m_decimators[c][stage].process(mix[c], mix[c], n);
+          n /= 2;
+        }
+      }
+    }
+    if (useMixBuffers)
+    {
+      for (int c = 0; c < numChannels; c++)
+      {
+        const Sample* src = mix[std::min(c, mixChannels - 1)];
+        Sample* buf = bufs[c];
+        for (int j = 0; j < bufsize; j++)
+        {
+          buf[j] += src[j];
+        }
+      }
+    }
+
+    for (int i = 0; i < m_garbageList.size(); i++)
     {
-      makeIdle(garbage_list[i]);
+      makeIdle(m_garbageList[i]);
     }
   }
 
@@ -170,16 +770,67 @@ namespace syn
     }
   }
 
+  bool VoiceManager::queueParameter(int uid, int pid, double val, int offset)
+  {
+    std::lock_guard<std::mutex> queueLock(m_queueMutex);
+    /*
+     * The prototype is never read by the audio thread, so it is updated here where voice sets are cloned from it. The
+     * caller may be the audio thread, so if another thread holds the prototype, possibly for a whole rebuildVoices(),
+     * the update is deferred to that thread instead of waited for. Later changes to the same parameter replace the
+     * deferred one.
+     */
+    std::unique_lock<std::mutex> protoLock(m_protoMutex, std::try_to_lock);
+    int deferred = 0;
+    if (!protoLock.owns_lock())
+    {
+      while (deferred < m_numDeferredParams && (m_deferredParams[deferred].uid != uid || m_deferredParams[deferred].pid != pid))
+        deferred++;
+      if (deferred == PARAM_QUEUE_SIZE)
+        return false;
+    }
+    if (!m_paramQueue.push({ uid, pid, val, offset }))
+      return false;
+    if (protoLock.owns_lock())
+    {
+      m_instrument->modifyParameter(uid, pid, val, SET);
+    }
+    else
+    {
+      m_deferredParams[deferred] = { uid, pid, val, offset };
+      m_numDeferredParams = std::max(m_numDeferredParams, deferred + 1);
+    }
+    return true;
+  }
+
+  void VoiceManager::flushParameterQueue(size_t blockOffset)
+  {
+    ParamEvent event;
+    while (m_paramQueue.pop(event))
+    {
+      // the unit may have been removed by a patch edit since the event was queued, and its id given to a unit of
+      // another class, with fewer parameters
+      if (m_allVoices.empty() || !m_allVoices[0]->hasUnit(event.uid))
+        continue;
+      if (event.pid < 0 || event.pid >= m_allVoices[0]->getUnit(event.uid).getNumParameters())
+        continue;
+      // changes past the end of the voices' next block wait in the parameters for the blocks that follow it
+      int offset = std::max(event.offset - int(blockOffset), 0) * m_oversampling;
+      for (int i = 0; i < m_allVoices.size(); i++)
+      {
+        m_allVoices[i]->getParameter(event.uid, event.pid).modAt(event.value, offset);
+      }
+    }
+  }
+
   int VoiceManager::getLowestVoiceInd() const
   {
     if (m_numVoices > 0)
     {
-      VoiceMap::const_iterator it;
-      for (it = m_voiceMap.begin(); it != m_voiceMap.end(); it++)
+      for (int note = 0; note < NUM_MIDI_NOTES; note++)
       {
-        if (!it->second.empty() && m_allVoices[it->second.back()]->isActive())
+        if (!m_voiceMap.empty(note) && m_allVoices[m_voiceMap.back(note)]->isActive())
         {
-          return it->second.back();
+          return m_voiceMap.back(note);
         }
       }
     }
@@ -190,10 +841,10 @@ namespace syn
   {
     if (m_numVoices > 0)
     {
-      for (VoiceList::const_reverse_iterator it = m_voiceStack.crbegin(); it != m_voiceStack.crend(); ++it)
+      for (int v = m_voiceStack.back(); v != m_voiceStack.end(); v = m_voiceStack.prev(v))
       {
-        if (m_allVoices[*it]->isActive())
-          return *it;
+        if (m_allVoices[v]->isActive())
+          return v;
       }
     }
     return 0;
@@ -203,10 +854,10 @@ namespace syn
   {
     if (m_numVoices > 0)
     {
-      for (VoiceList::const_iterator it = m_voiceStack.cbegin(); it != m_voiceStack.cend(); ++it)
+      for (int v = m_voiceStack.front(); v != m_voiceStack.end(); v = m_voiceStack.next(v))
       {
-        if (m_allVoices[*it]->isActive())
-          return *it;
+        if (m_allVoices[v]->isActive())
+          return v;
       }
     }
     return 0;
@@ -216,12 +867,11 @@ namespace syn
   {
     if (m_numVoices > 0)
     {
-      VoiceMap::const_reverse_iterator it;
-      for (it = m_voiceMap.crbegin(); it != m_voiceMap.crend(); ++it)
+      for (int note = NUM_MIDI_NOTES - 1; note >= 0; note--)
       {
-        if (!it->second.empty() && m_allVoices[it->second.back()]->isActive())
+        if (!m_voiceMap.empty(note) && m_allVoices[m_voiceMap.back(note)]->isActive())
         {
-          return it->second.back();
+          return m_voiceMap.back(note);
         }
       }
     }
@@ -2,36 +2,286 @@
 #define __VOICEMANAGER__
 
 #define MOD_FS_RAT 0
+#define MAX_VOICES 128
+#define NUM_MIDI_NOTES 128
+#define NUM_MIDI_CHANNELS 16
+#define MIDI_CC_DATA_ENTRY 6
+#define MIDI_CC_TIMBRE 74
+#define MIDI_CC_RPN_LSB 100
+#define MIDI_CC_RPN_MSB 101
+#define MIDI_RPN_MPE_CONFIG 6
+#define MIDI_RPN_NULL 0x3FFF
+#define PARAM_QUEUE_SIZE 1024
+#define SILENCE_THRESHOLD 1e-5 //!< peak level below which a voice's block counts as silent
+#define SILENCE_HOLD_TIME 0.05 //!< seconds a released voice must stay silent before it is made idle
+#define MAX_OVERSAMPLING 8
+#define NUM_DECIMATION_STAGES 3 //!< log2(MAX_OVERSAMPLING)
+#define MAX_OUTPUT_CHANNELS 2 //!< number of voice channels mixed by tick(); further channels are dropped
 #include "Instrument.h"
+#include "WorkerPool.h"
+#include "Filter.h"
+#include "SPSCQueue.h"
 #include <stdint.h>
 #include <string>
-#include <list>
+#include <atomic>
+#include <mutex>
 
-using std::list;
-using std::map;
 using std::string;
 namespace syn
 {
+  /**
+   * \class VoiceLists
+   *
+   * \brief A fixed number of doubly linked lists of voice indices, where each voice belongs to at most one list.
+   *
+   * The links are stored in fixed-size arrays indexed by voice, so every operation is O(1) and nothing is ever
+   * allocated. Each list is terminated by its own sentinel node, which is what end() returns:
+   *
+   *     for (int v = lists.front(l); v != lists.end(l); v = lists.next(v)) { ... }
+   */
+  template <int NLISTS>
+  class VoiceLists
+  {
+  public:
+    VoiceLists() { clear(); }
+
+    void clear()
+    {
+      for (int l = 0; l < NLISTS; l++)
+      {
+        m_next[end(l)] = m_prev[end(l)] = end(l);
+        m_size[l] = 0;
+      }
+      for (int v = 0; v < MAX_VOICES; v++)
+      {
+        m_listOf[v] = -1;
+      }
+    }
+
+    void push_back(int vind, int l = 0) { insertAfter(vind, m_prev[end(l)], l); }
+    void push_front(int vind, int l = 0) { insertAfter(vind, end(l), l); }
+
+    /**
+     * \brief Removes the voice from whichever list it belongs to, if any.
+     */
+    void remove(int vind)
+    {
+      int l = m_listOf[vind];
+      if (l < 0)
+        return;
+      m_next[m_prev[vind]] = m_next[vind];
+      m_prev[m_next[vind]] = m_prev[vind];
+      m_listOf[vind] = -1;
+      m_size[l]--;
+    }
+
+    /**
+     * \brief Puts vind in the place of other, which leaves its list. Does nothing if other is in no list.
+     */
+    void replace(int other, int vind)
+    {
+      int l = m_listOf[other];
+      if (l < 0)
+        return;
+      insertAfter(vind, m_prev[other], l);
+      remove(other);
+    }
+
+    int pop_front(int l = 0) { int vind = front(l); remove(vind); return vind; }
+    int front(int l = 0) const { return m_next[end(l)]; }
+    int back(int l = 0) const { return m_prev[end(l)]; }
+    int next(int vind) const { return m_next[vind]; }
+    int prev(int vind) const { return m_prev[vind]; }
+    int end(int l = 0) const { return MAX_VOICES + l; }
+    int size(int l = 0) const { return m_size[l]; }
+    bool empty(int l = 0) const { return m_size[l] == 0; }
+    bool contains(int vind, int l = 0) const { return m_listOf[vind] == l; }
+  private:
+    void insertAfter(int vind, int node, int l)
+    {
+      remove(vind);
+      m_prev[vind] = node;
+      m_next[vind] = m_next[node];
+      m_prev[m_next[node]] = vind;
+      m_next[node] = vind;
+      m_listOf[vind] = l;
+      m_size[l]++;
+    }
+
+    int m_next[MAX_VOICES + NLISTS];
+    int m_prev[MAX_VOICES + NLISTS];
+    int m_listOf[MAX_VOICES];
+    int m_size[NLISTS];
+  };
+
+  /**
+   * \brief A complete set of voices, built off the audio thread and handed over to it by VoiceManager::rebuildVoices().
+   */
+  struct VoiceSet
+  {
+    vector<Instrument*> voices;
+    vector<Arena*> arenas; //!< memory of each voice, in the same order as voices
+    int oversampling; //!< oversampling factor the voices were built for
+    VoiceSet* next; //!< link in the VoiceManager's list of retired sets
+    VoiceSet() : oversampling(1), next(nullptr) {}
+    ~VoiceSet();
+  };
+
+  /**
+   * \brief A change of a unit parameter's base value, sent to the audio thread through VoiceManager::queueParameter().
+   */
+  struct ParamEvent
+  {
+    int uid;
+    int pid;
+    double value;
+    int offset; //!< sample of the host block at which the change takes effect, see VoiceManager::tick()
+  };
+
   class VoiceManager
   {
   protected:
-    typedef list<int> VoiceList;
-    typedef map<int, VoiceList> VoiceMap;
+    typedef VoiceLists<1> VoiceList; //!< an age-ordered list of voices, oldest first
+    typedef VoiceLists<NUM_MIDI_NOTES> VoiceMap; //!< one list of voices per note number
+    typedef VoiceLists<NUM_MIDI_CHANNELS> ChannelMap; //!< one list of voices per MIDI channel
     int m_numVoices;
-    int m_maxVoices;
+    std::atomic<int> m_maxVoices; //!< number of voices, or the number the voice sets built next will have
     VoiceMap m_voiceMap;
-    VoiceList m_voiceStack;
-    VoiceList m_idleVoiceStack;
+    ChannelMap m_channelMap;
+    VoiceList m_voiceStack; //!< voices that are playing, oldest first
+    VoiceList m_idleVoiceStack; //!< free list of voices that can be allocated
     vector<Instrument*> m_allVoices;
+    vector<Arena*> m_voiceArenas; //!< memory of each voice's units, parameters and buffers
     Instrument* m_instrument;
-    int createVoice(int note, int vel);
+    vector<int> m_renderList; //!< voices being rendered in the current block, in mixdown order
+    vector<int> m_garbageList; //!< voices found inactive or silent in the current block
+    WorkerPool m_workerPool;
+    int m_minParallelVoices;
+    size_t m_bufSize; //!< block size of the voices, used to prepare voice sets built off the audio thread
+    size_t m_tickSize; //!< number of samples of each voice rendered by the current tick()
+    double m_Fs; //!< output sample rate
+    int m_oversampling; //!< ratio of the voices' sample rate to m_Fs
+    vector<Sample> m_mixBuffers[MAX_OUTPUT_CHANNELS]; //!< mix of each channel of the voices, sized for MAX_OVERSAMPLING
+    vector<HalfBandDecimator> m_decimators[MAX_OUTPUT_CHANNELS]; //!< decimation chain of each channel, only the last log2(m_oversampling) stages are used
+    uint8_t m_voiceVelocity[MAX_VOICES]; //!< velocity of the note each voice was last started with
+    bool m_voiceReleased[MAX_VOICES]; //!< whether each voice has received a note off since its note on
+    bool m_voiceSustained[MAX_VOICES]; //!< whether each voice's note off is being held back by the sustain pedal
+    double m_voicePressure[MAX_VOICES]; //!< poly aftertouch of each voice's note
+    uint8_t m_voiceChannel[MAX_VOICES]; //!< MIDI channel of each voice's note
+    size_t m_voiceSilentSamples[MAX_VOICES]; //!< number of samples each voice's output has stayed below SILENCE_THRESHOLD
+    double m_pitchBend; //!< pitch bend of the non-MPE channels, or of the zone manager channels in MPE mode
+    double m_channelPressure; //!< like m_pitchBend, for channel pressure
+    double m_controls[NUM_MIDI_CCS];
+    bool m_isSustained;
+    /*
+     * MPE state. Each zone has a manager channel (the first or the last channel) whose messages apply to all voices,
+     * and member channels whose messages only apply to the voices playing on them.
+     */
+    int m_lowerZoneSize; //!< number of member channels following channel 0
+    int m_upperZoneSize; //!< number of member channels preceding channel 15
+    double m_channelBend[NUM_MIDI_CHANNELS]; //!< pitch bend of each member channel, added to m_pitchBend
+    double m_memberPressure[NUM_MIDI_CHANNELS]; //!< channel pressure of each member channel, added to m_channelPressure
+    double m_channelTimbre[NUM_MIDI_CHANNELS]; //!< MIDI_CC_TIMBRE of each member channel
+    int m_rpn[NUM_MIDI_CHANNELS]; //!< registered parameter number selected on each channel
+    std::atomic<VoiceSet*> m_pendingVoices; //!< set published by rebuildVoices() that tick() has not picked up yet
+    std::atomic<VoiceSet*> m_retiredVoices; //!< sets replaced by tick(), waiting to be reclaimed off the audio thread
+    SPSCQueue<ParamEvent, PARAM_QUEUE_SIZE> m_paramQueue;
+    std::mutex m_protoMutex; //!< held while the prototype is cloned or modified; only ever tried by queueParameter()
+    std::mutex m_queueMutex; //!< serializes the producers of m_paramQueue; never held while the prototype is cloned
+    ParamEvent m_deferredParams[PARAM_QUEUE_SIZE]; //!< prototype changes queued while m_protoMutex was held, one per parameter
+    int m_numDeferredParams;
+    int createVoice(int note, int vel, int channel);
+    void startVoice(int vind, int note, int vel, int channel);
+    void releaseVoice(int vind, uint8_t velocity);
+    /**
+     * \brief Replaces a voice with a fresh clone of the prototype instrument, laid out contiguously in its own arena.
+     */
+    void rebuildVoice(int vind);
+    void destroyVoice(int vind);
+    /**
+     * \brief Moves the note playing on voice from, with its bookkeeping, to the idle voice to.
+     */
+    void moveVoice(int from, int to);
+    /**
+     * \brief Clears the history of the decimation chains, when the voices start rendering at another rate.
+     */
+    void resetDecimators();
+    /**
+     * \brief Rounds factor down to a supported oversampling factor.
+     */
+    static int roundOversampling(int factor);
+    void cloneVoice(Instrument*& voice, Arena*& arena) const;
+    /**
+     * \brief Replaces the voices with the pending set, if rebuildVoices() has published one, and carries the sounding
+     * notes over to the new voices. Called by the audio thread at the start of a block.
+     */
+    void swapInPendingVoices();
+    void retireVoices(VoiceSet* voices);
+    /**
+     * \brief Applies the prototype changes deferred by queueParameter() to the prototype, and to the voices of the
+     * given set if it is not null. The caller holds m_protoMutex and m_queueMutex, and must release m_protoMutex
+     * first, so that no change can be deferred after the last call.
+     */
+    void applyDeferredParameters(VoiceSet* voices);
+    /**
+     * \brief Applies the deferred prototype changes and releases m_protoMutex, for holders that publish no voice set.
+     */
+    void releasePrototype(std::unique_lock<std::mutex>& protoLock);
+    /**
+     * \brief Resizes the buffers of the voices being rendered, and those tick() mixes them in, for blocks of bufsize
+     * samples. Unlike setBufSize(), leaves a pending voice set alone, so it does not take m_protoMutex.
+     */
+    void resizeBuffers(size_t bufsize);
+    void collectRetiredVoices();
+    void sendMidiControl(MIDI_CONTROL control, int num, double value);
+    void sendToChannel(int channel, MIDI_CONTROL control, int num, double value);
+    /**
+     * \brief Sends the pitch bend, pressure and timbre of the voice's MPE channel to the voice.
+     */
+    void sendChannelControls(int vind);
+    void updateRpn(uint8_t cc, uint8_t value, uint8_t channel);
+    void releaseSustainedVoices();
+    /**
+     * \brief Sends the current controller values to every voice, after the voices have been rebuilt.
+     */
+    void restoreMidiControls();
+    static void renderVoice(void* vm, int renderind);
     void makeIdle();
     int findIdleVoice();
     void makeIdle(int vind);
 
   public:
-    void noteOn(uint8_t noteNumber, uint8_t velocity);
-    void noteOff(uint8_t noteNumber, uint8_t velocity);
+    void noteOn(uint8_t noteNumber, uint8_t velocity, uint8_t channel = 0);
+    /**
+     * \brief Releases the voices playing the note. In MPE mode, only the voices started on the same channel are released.
+     */
+    void noteOff(uint8_t noteNumber, uint8_t velocity, uint8_t channel = 0);
+    /**
+     * \brief Sets the pitch bend of all voices, in [-1,1]. In MPE mode, the pitch bend of a member channel only
+     * applies to its voices, on top of the pitch bend of the manager channel.
+     */
+    void pitchBend(double value, uint8_t channel = 0);
+    /**
+     * \brief Sets a controller of all voices. While the sustain pedal (MIDI_CC_SUSTAIN) is down, note offs are held
+     * back until it is released. In MPE mode, controllers of a member channel only apply to its voices.
+     *
+     * MPE configuration messages (RPN 6 on the first or last channel) set the size of the corresponding zone.
+     */
+    void controlChange(uint8_t cc, uint8_t value, uint8_t channel = 0);
+    /**
+     * \brief Sets the pressure of all voices. In MPE mode, the pressure of a member channel only applies to its voices,
+     * on top of the pressure of the manager channel.
+     */
+    void channelPressure(uint8_t value, uint8_t channel = 0);
+    void polyPressure(uint8_t noteNumber, uint8_t value, uint8_t channel = 0);
+    /**
+     * \brief Configures an MPE zone, as an MPE configuration message does. The lower zone is managed by the first
+     * channel and the upper zone by the last; numChannels is the number of member channels, 0 disabling the zone.
+     * MPE mode is on while either zone has member channels.
+     */
+    void setMpeZone(bool upper, int numChannels);
+    bool isMpeEnabled() const { return m_lowerZoneSize > 0 || m_upperZoneSize > 0; }
+    bool isMpeMemberChannel(int channel) const;
     Instrument* getLowestVoice() { int ind = getLowestVoiceInd(); return ind >= 0 ? m_allVoices[ind] : nullptr; };
     Instrument* getNewestVoice() { int ind = getNewestVoiceInd(); return ind >= 0 ? m_allVoices[ind] : nullptr; };
     Instrument* getOldestVoice() { int ind = getOldestVoiceInd(); return ind >= 0 ? m_allVoices[ind] : nullptr; };
@@ -44,19 +294,121 @@ namespace syn
     Instrument* getProtoInstrument() const { return m_instrument; };
     void setFs(double fs);
     void setBufSize(size_t bufsize);
+    /**
+     * \brief Sets the polyphony (at most MAX_VOICES) and rebuilds every voice as a clone of the given instrument.
+     */
     void setMaxVoices(int max, Instrument* v);
+    /**
+     * \brief Renders the voices at factor times the sample rate, which must be 1, 2, 4 or MAX_OVERSAMPLING (other
+     * values are rounded down), and decimates their mix back to the sample rate with a chain of half-band filters.
+     *
+     * Oversampling reduces the aliasing of waveforms with sharp edges at the cost of rendering factor times as many
+     * samples. The factor is stored in the prototype instrument, and taken from it by setMaxVoices(). A change is
+     * applied like a patch edit: the voices are rebuilt at the new rate by rebuildVoices() on the calling thread, and
+     * tick() switches to them, and to the new decimation chain, at the start of a block.
+     */
+    void setOversampling(int factor);
+    /**
+     * \brief Oversampling factor set by setOversampling(). The voices being rendered switch to it at the start of the
+     * block after their rebuild.
+     */
+    int getOversampling() const { return m_instrument ? m_instrument->getOversampling() : m_oversampling; }
+    /**
+     * \brief Rebuilds every voice from the prototype instrument without blocking the audio thread.
+     *
+     * The new voices are cloned on the calling thread and published atomically; tick() switches to them at the start
+     * of its next block, carrying the sounding notes over, and the replaced voices are freed by a later call.
+     * Concurrent calls are serialized. Must not be called while another thread edits the prototype's graph.
+     */
+    void rebuildVoices();
+    /**
+     * \brief Changes the number of voices like rebuildVoices() does, without interrupting the sounding notes, unless
+     * there are more of them than max. The oldest of those are dropped.
+     */
+    void resizeVoices(int max);
     int getNumVoices() const { return m_numVoices; };
     int getMaxVoices() const
     { return m_maxVoices; };
     void modifyParameter(int uid, int pid, double val, MOD_ACTION action);
-    void tick(double* buf, size_t bufsize);
+    /**
+     * \brief Sets a parameter of the prototype and queues the change for the voices, without waiting for the audio
+     * thread. The voices ramp to the new value from the given sample of the next host block, as set by the parameter's
+     * smoothing. May be called from any thread, and never waits for rebuildVoices(): while the prototype is being
+     * cloned, the change to it is left to the thread cloning it.
+     * \returns false, changing nothing, if the queue is full. Flushing the queue with flushParameterQueue() makes room.
+     */
+    bool queueParameter(int uid, int pid, double val, int offset = 0);
+    /**
+     * \brief Applies all queued parameter changes to the voices. Called by tick(); any other caller must exclude the
+     * audio thread.
+     * \param blockOffset sample of the host block at which the voices' next block starts. Changes scheduled before it
+     * take effect at the start of that block.
+     */
+    void flushParameterQueue(size_t blockOffset = 0);
+    /**
+     * \brief Renders bufsize samples of all active voices and adds each of their channels to the corresponding one
+     * of the numChannels buffers in bufs.
+     *
+     * The last channel of voices with fewer channels than requested is added to the remaining buffers as well, so a
+     * mono voice is heard in every channel. Voice channels beyond numChannels, or beyond MAX_OUTPUT_CHANNELS, are
+     * dropped.
+     *
+     * A block may be rendered in several calls, for instance to start notes at their exact sample. blockOffset is then
+     * the sample of the host block at which each call starts, which places the offsets given to queueParameter()
+     * relative to the host block rather than to the call. The voices are only resized if bufsize exceeds their
+     * buffers.
+     *
+     * When worker threads are enabled and at least getMinParallelVoices() voices are active, the voices are rendered
+     * in parallel. Voice outputs are always summed in the same order, so the result does not depend on the threading.
+     */
+    void tick(Sample** bufs, int numChannels, size_t bufsize, size_t blockOffset = 0);
+    /**
+     * \brief Renders the first channel of the voices into a single buffer, see tick(Sample**, int, size_t, size_t).
+     */
+    void tick(Sample* buf, size_t bufsize, size_t blockOffset = 0) { tick(&buf, 1, bufsize, blockOffset); }
+    /**
+     * \brief Sets the number of worker threads used to render voices, in addition to the calling thread. 0 renders
+     * all voices serially.
+     */
+    void setNumThreads(int numThreads) { m_workerPool.setNumThreads(numThreads); }
+    int getNumThreads() const { return m_workerPool.getNumThreads(); }
+    /**
+     * \brief Sets the number of active voices below which voices are rendered serially, since the cost of waking the
+     * workers outweighs the gain.
+     */
+    void setMinParallelVoices(int minvoices) { m_minParallelVoices = minvoices; }
+    int getMinParallelVoices() const { return m_minParallelVoices; }
     Signal1<Instrument*> m_onDyingVoice;
 
     VoiceManager() :
-      m_numVoices(0), m_maxVoices(0), m_instrument(nullptr)
+      m_numVoices(0), m_maxVoices(0), m_instrument(nullptr), m_minParallelVoices(4), m_bufSize(1), m_tickSize(1), m_Fs(48e3), m_oversampling(1),
+      m_pendingVoices(nullptr), m_retiredVoices(nullptr), m_pitchBend(0), m_channelPressure(0), m_isSustained(false),
+      m_lowerZoneSize(0), m_upperZoneSize(0), m_numDeferredParams(0)
     {
+      for (int i = 0; i < NUM_MIDI_CCS; i++)
+      {
+        m_controls[i] = 0;
+      }
+      for (int i = 0; i < MAX_VOICES; i++)
+      {
+        m_voiceChannel[i] = 0;
+      }
+      for (int ch = 0; ch < NUM_MIDI_CHANNELS; ch++)
+      {
+        m_channelBend[ch] = m_memberPressure[ch] = m_channelTimbre[ch] = 0;
+        m_rpn[ch] = MIDI_RPN_NULL;
+      }
+      // the later stages filter the transition bands of the earlier ones, so only the last stage needs to be sharp
+      for (int c = 0; c < MAX_OUTPUT_CHANNELS; c++)
+      {
+        for (int i = 0; i < NUM_DECIMATION_STAGES - 1; i++)
+        {
+          m_decimators[c].push_back(HalfBandDecimator(HALFBAND_SHORT_TAPS, 8.0));
+        }
+        m_decimators[c].push_back(HalfBandDecimator(HALFBAND_TAPS, 9.0));
+      }
     };
-    ~VoiceManager() {}
+    ~VoiceManager();
   };
 }
 #endif
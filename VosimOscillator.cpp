@@ -1,4 +1,7 @@
 #include "VosimOscillator.h"
+#include "DSPMath.h"
+#include <random>
+#include <algorithm>
 
 /******************************
 * VOSIM methods
@@ -15,28 +18,51 @@ namespace syn
     m_unwrapped_pulse_phase = vosc.m_unwrapped_pulse_phase;
   }
 
-  void VosimOscillator::process(int bufind)
+  void VosimOscillator::processBlock(const ParamBlock& params, Sample* out, size_t n)
   {
-    Oscillator::tick_phase();
-    m_pulse_step = m_Step*(m_number + 4 * m_ppitch);
-    m_unwrapped_pulse_phase = m_phase / m_Step * m_pulse_step;
-    if (m_unwrapped_pulse_phase < 1)
+    const Sample* gain = params[m_gain];
+    const Sample* decay = params[m_decay];
+    const Sample* ppitch = params[m_ppitch];
+    const Sample* number = params[m_number];
+    Oscillator::tick_phase(params, n);
+    // The phase buffers are reused in place: m_phases receives the pulse phase and m_steps the pulse amplitude.
+    Sample* phases = &m_phases[0];
+    Sample* steps = &m_steps[0];
+    for (int i = 0; i < n; i++)
     {
-      m_curr_pulse_gain = 1.0;
+      double step = steps[i];
+      m_pulse_step = step*(number[i] + 4 * ppitch[i]);
+      m_unwrapped_pulse_phase = phases[i] / step * m_pulse_step;
+      if (m_unwrapped_pulse_phase < 1)
+      {
+        m_curr_pulse_gain = 1.0;
+      }
+      if (m_unwrapped_pulse_phase >= number[i])
+      {
+        phases[i] = 0;
+        steps[i] = 0;
+      }
+      else
+      {
+        m_last_pulse_phase = m_pulse_phase;
+        m_pulse_phase = m_unwrapped_pulse_phase - (int)m_unwrapped_pulse_phase;
+        if (m_last_pulse_phase > m_pulse_phase) {
+          m_curr_pulse_gain *= decay[i];
+        }
+        phases[i] = m_pulse_phase;
+        steps[i] = gain[i] * m_velocity*m_curr_pulse_gain;
+      }
     }
-    if (m_unwrapped_pulse_phase >= m_number)
+    if (params.isConstant(m_gain) && gain[0] == 0)
     {
-      m_output[bufind] = 0;
+      // the pulses are multiplied by zero, so only their state needed updating
+      std::fill(out, out + n, 0.0);
+      return;
     }
-    else
+    lut_sin().getlinear(phases, out, n);
+    for (int i = 0; i < n; i++)
     {
-      m_last_pulse_phase = m_pulse_phase;
-      m_pulse_phase = m_unwrapped_pulse_phase - (int)m_unwrapped_pulse_phase;
-      if (m_last_pulse_phase > m_pulse_phase) {
-        m_curr_pulse_gain *= m_decay;
-      }
-      double tableval = lut_sin.getlinear(m_pulse_phase);
-      m_output[bufind] = m_gain*m_velocity*m_curr_pulse_gain*tableval;
+      out[i] *= steps[i];
     }
   }
 
@@ -46,4 +72,233 @@ namespace syn
     m_pulse_phase = 0;
     m_unwrapped_pulse_phase = 0;
   }
-}
\ No newline at end of file
+
+  void VosimOscillator::copyStateImpl(const Unit& other)
+  {
+    Oscillator::copyStateImpl(other);
+    const VosimOscillator& vosc = static_cast<const VosimOscillator&>(other);
+    m_curr_pulse_gain = vosc.m_curr_pulse_gain;
+    m_pulse_step = vosc.m_pulse_step;
+    m_pulse_phase = vosc.m_pulse_phase;
+    m_last_pulse_phase = vosc.m_last_pulse_phase;
+    m_unwrapped_pulse_phase = vosc.m_unwrapped_pulse_phase;
+  }
+}
+namespace syn
+{
+  VosimChoir::VosimChoir(string name, size_t size) :
+    SourceUnit(name),
+    m_gain(addParam("gain", DOUBLE_TYPE, 0, 1, 0.5)),
+    m_decay(addParam("decay", DOUBLE_TYPE, 0, 0.9, 0.5)),
+    m_harmonicdecay(addParam("harmonicdecay", DOUBLE_TYPE, -1, 1, -0.5)),
+    m_ppitch(addParam("pulsepitch", DOUBLE_TYPE, 0, 1, 0.5)),
+    m_number(addParam("number", INT_TYPE, 0, 4, 1.0)),
+    m_tune(addParam("tune", DOUBLE_TYPE, -12, 12, 0.0)),
+    m_pitchdrift(addParam("pulse_drift", DOUBLE_TYPE, 0, 12.0, 0.125)),
+    m_driftfreq(addParam("drift_freq", DOUBLE_TYPE, -64, 128, 0)),
+    m_size(addParam("size", INT_TYPE, 1, MAX_CHOIR_SIZE, size)),
+    m_spread(addParam("spread", DOUBLE_TYPE, 0, 1, 0.0)),
+    m_pitch(0),
+    m_velocity(1.0),
+    m_phases(1, 0.0),
+    m_amps(1, 0.0),
+    m_driftSteps(1, 0.0),
+    m_harmonicGains(1, 0.0)
+  {
+    setNumChannels(2);
+    random_device rd;
+    for (int i = 0; i < MAX_CHOIR_SIZE; i++)
+    {
+      m_step[i] = 440. / m_Fs;
+      m_basePhase[i] = 0;
+      m_pulsePhase[i] = 0;
+      m_pulseGain[i] = 1.0;
+      m_driftPhase[i] = 0;
+      m_driftCurr[i] = 0;
+      m_driftNext[i] = rd();
+    }
+  }
+
+  void VosimChoir::noteOn(int pitch, int vel)
+  {
+    m_pitch = pitch;
+    m_velocity = vel / 255.0;
+    for (int i = 0; i < MAX_CHOIR_SIZE; i++)
+    {
+      m_basePhase[i] = 0;
+      m_pulsePhase[i] = 0;
+    }
+  }
+
+  void VosimChoir::copyStateImpl(const Unit& other)
+  {
+    const VosimChoir& choir = static_cast<const VosimChoir&>(other);
+    m_pitch = choir.m_pitch;
+    m_velocity = choir.m_velocity;
+    for (int i = 0; i < MAX_CHOIR_SIZE; i++)
+    {
+      m_step[i] = choir.m_step[i];
+      m_basePhase[i] = choir.m_basePhase[i];
+      m_pulsePhase[i] = choir.m_pulsePhase[i];
+      m_pulseGain[i] = choir.m_pulseGain[i];
+      m_driftPhase[i] = choir.m_driftPhase[i];
+      m_driftCurr[i] = choir.m_driftCurr[i];
+      m_driftNext[i] = choir.m_driftNext[i];
+    }
+  }
+
+  void VosimChoir::resizeOutputBuffer(size_t newbufsize)
+  {
+    SourceUnit::resizeOutputBuffer(newbufsize);
+    m_phases.resize(newbufsize);
+    m_amps.resize(newbufsize);
+    m_driftSteps.resize(newbufsize);
+    m_harmonicGains.resize(newbufsize);
+  }
+
+  void VosimChoir::processBlock(const ParamBlock& params, Sample* out, size_t n)
+  {
+    const Sample* gain = params[m_gain];
+    const Sample* decay = params[m_decay];
+    const Sample* harmonicdecay = params[m_harmonicdecay];
+    const Sample* ppitch = params[m_ppitch];
+    const Sample* number = params[m_number];
+    const Sample* tune = params[m_tune];
+    const Sample* pitchdrift = params[m_pitchdrift];
+    const Sample* driftfreq = params[m_driftfreq];
+    Sample* phases = &m_phases[0];
+    Sample* amps = &m_amps[0];
+    Sample* steps = amps; // each step is consumed before the pulse amplitude replacing it is written
+    Sample* driftsteps = &m_driftSteps[0];
+    Sample* harmonicgains = &m_harmonicGains[0];
+    int size = std::min(std::max(int(params[m_size][0]), 1), MAX_CHOIR_SIZE);
+    const Sample* spread = params[m_spread];
+    Sample* right = out + getBufferSize();
+    bool isSpread = !params.isConstant(m_spread) || spread[0] != 0;
+
+    // every member's drift runs at the same rate
+    if (params.isConstant(m_driftfreq))
+    {
+      std::fill(driftsteps, driftsteps + n, pitchToFreq(driftfreq[0]) / m_Fs);
+    }
+    else
+    {
+      pitchToFreq(driftfreq, driftsteps, n);
+      for (int j = 0; j < n; j++)
+      {
+        driftsteps[j] /= m_Fs;
+      }
+    }
+    std::fill(out, out + n, 0.0);
+    if (isSpread)
+      std::fill(right, right + n, 0.0);
+    std::fill(harmonicgains, harmonicgains + n, 1.0);
+
+    for (int i = 0; i < size; i++)
+    {
+      // pitch, drifting along a linearly interpolated random walk
+      double driftphase = m_driftPhase[i];
+      uint32_t driftcurr = m_driftCurr[i], driftnext = m_driftNext[i];
+      for (int j = 0; j < n; j++)
+      {
+        driftphase += driftsteps[j];
+        if (driftphase >= 1)
+          driftphase -= 1;
+        if (driftphase < driftsteps[j])
+        {
+          driftcurr = driftnext;
+          driftnext = 69069 * driftnext + 1;
+        }
+        double drift = pitchdrift[j] * (LERP((driftcurr / double(0x7FFFFFFF)), (driftnext / double(0x7FFFFFFF)), driftphase) - 1.0);
+        steps[j] = m_pitch + (tune[j] + drift);
+      }
+      m_driftPhase[i] = driftphase;
+      m_driftCurr[i] = driftcurr;
+      m_driftNext[i] = driftnext;
+
+      // oscillator phase
+      pitchToFreq(steps, steps, n);
+      double basephase = m_basePhase[i];
+      for (int j = 0; j < n; j++)
+      {
+        steps[j] /= m_Fs;
+        basephase += steps[j];
+        if (basephase >= 1)
+          basephase -= 1;
+        phases[j] = basephase;
+      }
+      m_basePhase[i] = basephase;
+      m_step[i] = steps[n - 1];
+
+      // pulse train, overwriting the phases with the pulse phases
+      double pulsephase = m_pulsePhase[i];
+      double pulsegain = m_pulseGain[i];
+      for (int j = 0; j < n; j++)
+      {
+        double step = steps[j];
+        double pulsenumber = number[j] + i;
+        double unwrapped = phases[j] / step * (step * (pulsenumber + 4 * ppitch[j]));
+        if (unwrapped < 1)
+        {
+          pulsegain = 1.0;
+        }
+        if (unwrapped >= pulsenumber)
+        {
+          phases[j] = 0;
+          amps[j] = 0;
+        }
+        else
+        {
+          double lastpulsephase = pulsephase;
+          pulsephase = unwrapped - (int)unwrapped;
+          if (lastpulsephase > pulsephase)
+          {
+            pulsegain *= decay[j];
+          }
+          phases[j] = pulsephase;
+          amps[j] = m_velocity * pulsegain;
+        }
+      }
+      m_pulsePhase[i] = pulsephase;
+      m_pulseGain[i] = pulsegain;
+
+      lut_sin().getlinear(phases, phases, n);
+      if (isSpread)
+      {
+        // the first member stays centered and the others alternate sides, moving outwards as they get quieter
+        double position = size > 1 ? (i % 2 ? -1.0 : 1.0) * ((i + 1) / 2) / (size / 2) : 0.0;
+        for (int j = 0; j < n; j++)
+        {
+          double x = harmonicgains[j] * (phases[j] * amps[j]);
+          double pan = spread[j] * position;
+          out[j] += x * std::min(1.0, 1.0 - pan);
+          right[j] += x * std::min(1.0, 1.0 + pan);
+          harmonicgains[j] *= harmonicdecay[j];
+        }
+      }
+      else
+      {
+        for (int j = 0; j < n; j++)
+        {
+          out[j] += harmonicgains[j] * (phases[j] * amps[j]);
+          harmonicgains[j] *= harmonicdecay[j];
+        }
+      }
+    }
+    for (int j = 0; j < n; j++)
+    {
+      out[j] *= gain[j];
+    }
+    if (isSpread)
+    {
+      for (int j = 0; j < n; j++)
+      {
+        right[j] *= gain[j];
+      }
+    }
+    else
+    {
+      std::copy(out, out + n, right);
+    }
+  }
+}
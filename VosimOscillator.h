@@ -3,9 +3,10 @@
 
 #include "Oscillator.h"
 #include "SourceUnit.h"
-#include "RandomOscillator.h"
-#include <random>
 #include <cmath>
+#include <cstdint>
+
+#define MAX_CHOIR_SIZE 32
 
 using namespace std;
 
@@ -28,7 +29,7 @@ namespace syn
     };
 
     VosimOscillator(const VosimOscillator& vosc);
-    virtual void process(int bufind) override;
+    virtual void processBlock(const ParamBlock& params, Sample* out, size_t n) override;
     virtual void sync() override;
     UnitParameter& m_relativeamt;
     UnitParameter& m_decay;
@@ -46,6 +47,8 @@ namespace syn
       return "VosimOscillator";
     }
 
+    virtual void copyStateImpl(const Unit& other) override;
+
     double m_curr_pulse_gain;
     double m_pulse_step;
     double m_pulse_phase;
@@ -53,89 +56,39 @@ namespace syn
     double m_unwrapped_pulse_phase;
   };
 
+  /**
+   * \class VosimChoir
+   *
+   * \brief A bank of VOSIM oscillators playing the same note, each with its own randomly drifting tuning.
+   *
+   * Member i emits number+i pulses per period, and is weighted by harmonicdecay^i. The members are rendered by a
+   * single block kernel that keeps their state in parallel arrays, so the cost of the choir grows with its size
+   * only by the cost of the oscillators themselves.
+   *
+   * The output is stereo. With a nonzero spread the members alternate between the left and right channels; the
+   * spread is only heard through a stereo input, such as that of a PanningUnit, since parameters otherwise read the
+   * left channel.
+   */
   class VosimChoir : public SourceUnit
   {
   public:
-    VosimChoir(string name, size_t size = 4) :
-      SourceUnit(name),
-      m_gain(addParam("gain", DOUBLE_TYPE, 0, 1, 0.5)),
-      m_decay(addParam("decay", DOUBLE_TYPE, 0, 0.9, 0.5)),
-      m_harmonicdecay(addParam("harmonicdecay", DOUBLE_TYPE, -1, 1, -0.5)),
-      m_ppitch(addParam("pulsepitch", DOUBLE_TYPE, 0, 1, 0.5)),
-      m_number(addParam("number", INT_TYPE, 0, 4, 1.0)),
-      m_tune(addParam("tune", DOUBLE_TYPE, -12, 12, 0.0)),
-      m_pitchdrift(addParam("pulse_drift", DOUBLE_TYPE, 0, 12.0, 0.125)),
-      m_driftfreq(addParam("drift_freq", DOUBLE_TYPE, -64, 128, 0)),
-      m_size(size)
-    {
-      assert(size > 0);
-      m_choir = static_cast<VosimOscillator**>(malloc(m_size * sizeof(VosimOscillator*)));
-      m_pulsedrifters = static_cast<UniformRandomOscillator**>(malloc(m_size * sizeof(UniformRandomOscillator*)));
-      for (int i = 0; i < m_size; i++)
-      {
-        m_choir[i] = new VosimOscillator(name);
-        m_choir[i]->getParam("gain").mod(1.0,SET);
-        m_pulsedrifters[i] = new UniformRandomOscillator(name);
-        m_choir[i]->getParam("tune").addConnection(&m_pulsedrifters[i]->getLastOutputBuffer(), ADD);
-      }
-    }
+    VosimChoir(string name, size_t size = 4);
+    VosimChoir(const VosimChoir& other) : VosimChoir(other.m_name, other.m_size.getDefault())
+    {}
+    virtual ~VosimChoir() {}
 
-    VosimChoir(const VosimChoir& other) : VosimChoir(other.m_name, other.m_size)
-    {
-    }
-
-    virtual ~VosimChoir()
-    {
-      for (int i = 0; i < m_size; i++)
-      {
-        delete m_choir[i];
-        delete m_pulsedrifters[i];
-      }
-      delete m_choir;
-      delete m_pulsedrifters;
-    }
-
-    //virtual void resizeOutputBuffer(size_t size)
-    //{
-    //  Unit::resizeOutputBuffer(size);
-    //  for (int i = 0; i < m_size; i++)
-    //  {
-    //    m_choir[i]->resizeOutputBuffer(size);
-    //    m_pulsedrifters[i]->resizeOutputBuffer(size);
-    //  }
-    //}
     virtual bool isActive() const override
     {
       return m_gain != 0;
     };
 
-    virtual void noteOn(int pitch, int vel) override
-    {
-      for (int i = 0; i < m_size; i++)
-      {
-        m_choir[i]->noteOn(pitch, vel);
-      }
-    }
-
-    virtual void noteOff(int pitch, int vel) override
-    {
-      for (int i = 0; i < m_size; i++)
-      {
-        m_choir[i]->noteOff(pitch, vel);
-      }
-    }
-
-    virtual void setFs(double fs) override
-    {
-      for (int i = 0; i < m_size; i++)
-      {
-        m_choir[i]->setFs(fs);
-      }
-    }
+    virtual void noteOn(int pitch, int vel) override;
+    virtual void noteOff(int pitch, int vel) override {}
+    virtual void resizeOutputBuffer(size_t newbufsize) override;
 
     virtual int getSamplesPerPeriod() const override
     {
-      return m_choir[0]->getSamplesPerPeriod();
+      return (int)(floor(1. / m_step[0]));
     }
 
     UnitParameter& m_gain;
@@ -146,36 +99,25 @@ namespace syn
     UnitParameter& m_tune;
     UnitParameter& m_pitchdrift;
     UnitParameter& m_driftfreq;
+    UnitParameter& m_size;
+    UnitParameter& m_spread;
   protected:
-    virtual void process(int bufind) override
-    {
-      m_output[bufind] = 0;
-      double harmonicgain = 1.0;
-      for (int i = 0; i < m_size; i++)
-      {
-        m_choir[i]->m_decay.mod(m_decay, SET);
-
-        m_choir[i]->m_ppitch.mod(m_ppitch, SET);
-
-        m_choir[i]->m_number.mod(m_number + i, SET);
-
-        m_pulsedrifters[i]->m_pitch.mod(m_driftfreq, SET);
-        m_pulsedrifters[i]->m_gain.mod(m_pitchdrift, SET);
-        m_choir[i]->m_finetune.mod(m_tune, SET);
-
-        m_pulsedrifters[i]->tick();
-        m_choir[i]->tick();
-
-        m_output[bufind] += harmonicgain * m_choir[i]->getLastOutput();
-        harmonicgain *= m_harmonicdecay;
-      }
-      m_output[bufind] *= m_gain;
-    }
-
+    virtual void processBlock(const ParamBlock& params, Sample* out, size_t n) override;
   private:
-    VosimOscillator** m_choir;
-    UniformRandomOscillator** m_pulsedrifters;
-    size_t m_size;
+    double m_pitch;
+    double m_velocity;
+    /* per member state */
+    double m_step[MAX_CHOIR_SIZE]; //!< phase increment of the last sample
+    double m_basePhase[MAX_CHOIR_SIZE];
+    double m_pulsePhase[MAX_CHOIR_SIZE];
+    double m_pulseGain[MAX_CHOIR_SIZE];
+    double m_driftPhase[MAX_CHOIR_SIZE];
+    uint32_t m_driftCurr[MAX_CHOIR_SIZE], m_driftNext[MAX_CHOIR_SIZE];
+    /* scratch buffers, shared by the members */
+    SampleVec m_phases;
+    SampleVec m_amps;
+    SampleVec m_driftSteps;
+    SampleVec m_harmonicGains;
 
     virtual Unit* cloneImpl() const override
     {
@@ -186,6 +128,8 @@ namespace syn
     {
       return "VosimChoir";
     }
+
+    virtual void copyStateImpl(const Unit& other) override;
   };
 }
 
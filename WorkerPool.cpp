@@ -0,0 +1,130 @@
+#include "WorkerPool.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CPU_RELAX() _mm_pause()
+#else
+#define CPU_RELAX() std::this_thread::yield()
+#endif
+
+#define WORKER_SPIN_COUNT 20000 //!< number of polls an idle worker makes before parking
+
+namespace syn
+{
+  namespace
+  {
+    inline uint32_t epochOf(uint64_t work) { return uint32_t(work >> 32); }
+    inline int numJobsOf(uint64_t work) { return int((work >> 16) & 0xFFFF); }
+    inline int nextJobOf(uint64_t work) { return int(work & 0xFFFF); }
+  }
+
+  WorkerPool::WorkerPool() :
+    m_work(0),
+    m_done(0),
+    m_sleeping(0),
+    m_quit(false),
+    m_job(nullptr),
+    m_ctx(nullptr),
+    m_epoch(0)
+  {}
+
+  WorkerPool::~WorkerPool()
+  {
+    stopThreads();
+  }
+
+  void WorkerPool::setNumThreads(int numThreads)
+  {
+    if (numThreads < 0)
+      numThreads = 0;
+    if (numThreads == m_threads.size())
+      return;
+    stopThreads();
+    m_quit = false;
+    for (int i = 0; i < numThreads; i++)
+    {
+      m_threads.push_back(std::thread(&WorkerPool::workerLoop, this));
+    }
+  }
+
+  void WorkerPool::stopThreads()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_parkMutex);
+      m_quit = true;
+    }
+    m_parkCond.notify_all();
+    for (int i = 0; i < m_threads.size(); i++)
+    {
+      m_threads[i].join();
+    }
+    m_threads.clear();
+  }
+
+  void WorkerPool::run(JobFunc job, void* ctx, int numJobs)
+  {
+    if (m_threads.empty() || numJobs <= 1)
+    {
+      for (int i = 0; i < numJobs; i++)
+      {
+        job(ctx, i);
+      }
+      return;
+    }
+    m_job = job;
+    m_ctx = ctx;
+    m_done.store(0);
+    m_epoch++;
+    m_work.store((uint64_t(m_epoch) << 32) | (uint64_t(numJobs & 0xFFFF) << 16));
+    if (m_sleeping.load() > 0)
+    {
+      // taking the lock guarantees a worker that is about to park sees the new batch or receives the notification
+      std::lock_guard<std::mutex> lock(m_parkMutex);
+      m_parkCond.notify_all();
+    }
+    runJobs(m_epoch);
+    while (m_done.load(std::memory_order_acquire) < numJobs)
+    {
+      CPU_RELAX();
+    }
+  }
+
+  void WorkerPool::runJobs(uint32_t epoch)
+  {
+    uint64_t work = m_work.load(std::memory_order_acquire);
+    while (epochOf(work) == epoch && nextJobOf(work) < numJobsOf(work))
+    {
+      if (m_work.compare_exchange_weak(work, work + 1, std::memory_order_acq_rel))
+      {
+        m_job(m_ctx, nextJobOf(work));
+        m_done.fetch_add(1, std::memory_order_release);
+        work = m_work.load(std::memory_order_acquire);
+      }
+    }
+  }
+
+  void WorkerPool::workerLoop()
+  {
+    uint32_t seen = epochOf(m_work.load());
+    while (!m_quit.load())
+    {
+      int spins = 0;
+      uint64_t work;
+      while (epochOf(work = m_work.load(std::memory_order_acquire)) == seen && !m_quit.load())
+      {
+        if (++spins < WORKER_SPIN_COUNT)
+        {
+          CPU_RELAX();
+          continue;
+        }
+        std::unique_lock<std::mutex> lock(m_parkMutex);
+        m_sleeping++;
+        m_parkCond.wait(lock, [this, seen]() { return epochOf(m_work.load()) != seen || m_quit.load(); });
+        m_sleeping--;
+        spins = 0;
+      }
+      seen = epochOf(work);
+      runJobs(seen);
+    }
+  }
+}
@@ -0,0 +1,58 @@
+#ifndef __WORKERPOOL__
+#define __WORKERPOOL__
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace syn
+{
+  /**
+   * \class WorkerPool
+   *
+   * \brief A small pool of threads that execute batches of independent jobs on behalf of the audio thread.
+   *
+   * A batch is published with a single atomic store, and jobs are claimed lock-free by the workers and by the calling
+   * thread, which always participates. Idle workers spin briefly waiting for the next batch, then park on a condition
+   * variable. Nothing is allocated by run(), so it may be called from the audio thread.
+   */
+  class WorkerPool
+  {
+  public:
+    typedef void(*JobFunc)(void* ctx, int jobind);
+
+    WorkerPool();
+    ~WorkerPool();
+    /**
+     * \brief Sets the number of worker threads, not counting the calling thread. Must not be called from inside run().
+     */
+    void setNumThreads(int numThreads);
+    int getNumThreads() const { return m_threads.size(); }
+    /**
+     * \brief Calls job(ctx, i) for each i in [0, numJobs) and returns once all jobs have completed.
+     */
+    void run(JobFunc job, void* ctx, int numJobs);
+  private:
+    void workerLoop();
+    void runJobs(uint32_t epoch);
+    void stopThreads();
+
+    /**
+     * Packs the batch epoch (upper 32 bits), number of jobs (next 16 bits) and index of the next unclaimed job
+     * (lower 16 bits) into one word, so a job can only be claimed by a thread that observed the matching batch.
+     */
+    std::atomic<uint64_t> m_work;
+    std::atomic<int> m_done;
+    std::atomic<int> m_sleeping;
+    std::atomic<bool> m_quit;
+    JobFunc m_job;
+    void* m_ctx;
+    uint32_t m_epoch;
+    std::mutex m_parkMutex;
+    std::condition_variable m_parkCond;
+    std::vector<std::thread> m_threads;
+  };
+}
+#endif
@@ -0,0 +1,353 @@
+/**
+ * vosimbench: measures the cost of the synthesis hot paths and prints the results as JSON.
+ *
+ * Three groups of measurements are made:
+ *  - units: Unit::tick for every unit registered by registerStandardUnits (every waveform for Osc.Basic)
+ *  - circuits: Circuit::tick over synthetic graphs of oscillators mixed down by trees of accumulators, using the
+ *    worker pool for independent units when --threads is given
+ *  - voice_manager: VoiceManager::tick over a typical patch, for a range of voice counts and buffer sizes
+ *
+ * Each measurement is repeated and both the fastest and the median repetition are reported, in nanoseconds per
+ * output sample.
+ */
+#include "StandardUnits.h"
+#include "Circuit.h"
+#include "Envelope.h"
+#include "Instrument.h"
+#include "Oscillator.h"
+#include "VoiceManager.h"
+#include "VosimOscillator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace syn;
+using std::string;
+using std::vector;
+
+namespace
+{
+  struct BenchConfig
+  {
+    double fs;
+    int bufsize;
+    int reps;
+    double minSamples; //!< number of samples rendered by each repetition, at least
+    int threads;
+    bool quick;
+  };
+
+  struct Timing
+  {
+    double best;
+    double median;
+  };
+
+  /**
+   * Times tick(), which must produce samplesPerTick output samples, and returns the cost per output sample.
+   */
+  Timing measure(const BenchConfig& cfg, int samplesPerTick, const std::function<void()>& tick)
+  {
+    int ticksPerRep = std::max(1, int(std::ceil(cfg.minSamples / samplesPerTick)));
+    // warm up caches and let units settle into their steady state
+    for (int i = 0; i < std::min(ticksPerRep, 16); i++)
+    {
+      tick();
+    }
+    vector<double> results;
+    for (int r = 0; r < cfg.reps; r++)
+    {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      for (int i = 0; i < ticksPerRep; i++)
+      {
+        tick();
+      }
+      std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+      double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+      results.push_back(ns / (double(ticksPerRep) * samplesPerTick));
+    }
+    std::sort(results.begin(), results.end());
+    return{ results.front(), results[results.size() / 2] };
+  }
+
+  string jsonEscape(const string& str)
+  {
+    string escaped;
+    for (char c : str)
+    {
+      if (c == '"' || c == '\\')
+        escaped += '\\';
+      escaped += c;
+    }
+    return escaped;
+  }
+
+  class JsonList
+  {
+  public:
+    JsonList(FILE* out, const char* name, bool last = false) :
+      m_out(out),
+      m_first(true),
+      m_last(last)
+    {
+      fprintf(m_out, "  \"%s\": [", name);
+    }
+    ~JsonList()
+    {
+      fprintf(m_out, "%s]%s\n", m_first ? "" : "\n  ", m_last ? "" : ",");
+    }
+    FILE* item()
+    {
+      fprintf(m_out, "%s\n    ", m_first ? "" : ",");
+      m_first = false;
+      return m_out;
+    }
+  private:
+    FILE* m_out;
+    bool m_first;
+    bool m_last;
+  };
+
+  void benchUnit(const BenchConfig& cfg, JsonList& list, Unit* unit, const string& name, const string& variant)
+  {
+    unit->resizeOutputBuffer(cfg.bufsize);
+    unit->setFs(cfg.fs);
+    SourceUnit* source = dynamic_cast<SourceUnit*>(unit);
+    if (source)
+      source->noteOn(60, 100);
+    Timing t = measure(cfg, cfg.bufsize, [unit]() { unit->tick(); });
+    fprintf(list.item(), "{\"unit\": \"%s\", \"variant\": \"%s\", \"bufsize\": %d, \"ns_per_sample\": %.3f, "
+            "\"ns_per_sample_median\": %.3f}", jsonEscape(name).c_str(), jsonEscape(variant).c_str(), cfg.bufsize,
+            t.best, t.median);
+  }
+
+  void benchUnits(const BenchConfig& cfg, FILE* out)
+  {
+    UnitFactory factory;
+    registerStandardUnits(factory);
+    JsonList list(out, "units");
+
+    // a full scale signal for units whose inputs would otherwise be idle
+    SampleVec signal(cfg.bufsize);
+    for (int i = 0; i < cfg.bufsize; i++)
+    {
+      signal[i] = std::sin(2 * 3.14159265358979 * i / 64.0);
+    }
+
+    const vector<string>& names = factory.getPrototypeNames();
+    for (int i = 0; i < names.size(); i++)
+    {
+      Unit* unit = factory.createUnit(i);
+      if (unit->hasParameter("input"))
+        unit->getParam("input").addConnection(&signal, ADD);
+      benchUnit(cfg, list, unit, names[i], "");
+      delete unit;
+    }
+
+    const vector<string>& srcnames = factory.getSourcePrototypeNames();
+    for (int i = 0; i < srcnames.size(); i++)
+    {
+      Unit* unit = factory.createSourceUnit(i);
+      if (dynamic_cast<BasicOscillator*>(unit))
+      {
+        delete unit;
+        for (int wf = 0; wf < NUM_OSC_MODES; wf++)
+        {
+          unit = factory.createSourceUnit(i);
+          unit->getParam("waveform").mod(wf, SET);
+          benchUnit(cfg, list, unit, srcnames[i], OSC_MODE_NAMES[wf]);
+          delete unit;
+        }
+        continue;
+      }
+      benchUnit(cfg, list, unit, srcnames[i], "");
+      delete unit;
+    }
+  }
+
+  /**
+   * Builds a circuit of numunits units: oscillators of every waveform, summed pairwise by a tree of accumulators whose
+   * root is the sink.
+   */
+  Circuit* makeSyntheticCircuit(int numunits)
+  {
+    Circuit* circ = new Circuit();
+    int numsources = (numunits + 1) / 2;
+    vector<int> pending;
+    for (int i = 0; i < numsources; i++)
+    {
+      BasicOscillator* osc = new BasicOscillator("osc" + std::to_string(i));
+      osc->m_waveform.mod(i % NUM_OSC_MODES, SET);
+      osc->m_gain.mod(0.5, SET);
+      osc->noteOn(36 + (i * 7) % 60, 100);
+      pending.push_back(circ->addUnit(osc));
+    }
+    for (int i = numsources; i < numunits; i++)
+    {
+      int uid = circ->addUnit(new AccumulatingUnit("acc" + std::to_string(i)));
+      int fanin = std::min<int>(2, pending.size());
+      for (int j = 0; j < fanin; j++)
+      {
+        circ->addConnection({ pending[j], uid, circ->getUnit(uid).getParamId("input"), ADD });
+      }
+      pending.erase(pending.begin(), pending.begin() + fanin);
+      pending.push_back(uid);
+    }
+    circ->setSinkId(pending.back());
+    return circ;
+  }
+
+  void benchCircuits(const BenchConfig& cfg, FILE* out)
+  {
+    JsonList list(out, "circuits");
+    WorkerPool pool;
+    pool.setNumThreads(cfg.threads);
+    WorkerPool* poolptr = cfg.threads > 0 ? &pool : nullptr;
+    const int sizes[] = { 10, 100, 1000 };
+    for (int numunits : sizes)
+    {
+      Circuit* circ = makeSyntheticCircuit(numunits);
+      circ->setFs(cfg.fs);
+      circ->setBufSize(cfg.bufsize);
+      Timing t = measure(cfg, cfg.bufsize, [circ, poolptr]() { circ->tick(poolptr); });
+      fprintf(list.item(), "{\"units\": %d, \"bufsize\": %d, \"threads\": %d, \"ns_per_sample\": %.3f, "
+              "\"ns_per_sample_median\": %.3f, \"ns_per_unit_sample\": %.3f}", numunits, cfg.bufsize, cfg.threads,
+              t.best, t.median, t.best / numunits);
+      delete circ;
+    }
+  }
+
+  /**
+   * A typical patch: a VOSIM and a basic oscillator mixed by an accumulator whose gain follows an envelope.
+   */
+  Instrument* makeVoicePatch()
+  {
+    Instrument* instr = new Instrument();
+    Envelope* env = new Envelope("env");
+    VosimOscillator* vosc = new VosimOscillator("vosc");
+    BasicOscillator* osc = new BasicOscillator("osc");
+    LFOOscillator* lfo = new LFOOscillator("lfo");
+    vosc->m_gain.mod(0.5, SET);
+    osc->m_gain.mod(0.5, SET);
+    lfo->m_gain.mod(0.2, SET);
+    lfo->m_pitch.mod(40, SET);
+    instr->addSource(env);
+    instr->addSource(vosc);
+    instr->addSource(osc);
+    instr->addSource(lfo);
+    instr->addUnit(new AccumulatingUnit("acc"));
+    instr->resetPrimarySource(instr->getUnitId("env"));
+    instr->addConnection("vosc", "acc", "input", ADD);
+    instr->addConnection("osc", "acc", "input", ADD);
+    instr->addConnection("env", "acc", "gain", SCALE);
+    instr->addConnection("lfo", "vosc", "tune", ADD);
+    instr->setSinkName("acc");
+    return instr;
+  }
+
+  void benchVoiceManager(const BenchConfig& cfg, FILE* out)
+  {
+    JsonList list(out, "voice_manager", true);
+    Instrument* instr = makeVoicePatch();
+    for (int voices = 1; voices <= MAX_VOICES; voices *= 2)
+    {
+      for (int bufsize = 32; bufsize <= 2048; bufsize *= 2)
+      {
+        if (cfg.quick && bufsize != 32 && bufsize != 256 && bufsize != 2048)
+          continue;
+        VoiceManager vm;
+        vm.setMaxVoices(voices, instr);
+        vm.setNumThreads(cfg.threads);
+        vm.setBufSize(bufsize);
+        vm.setFs(cfg.fs);
+        for (int v = 0; v < voices; v++)
+        {
+          vm.noteOn(v, 100);
+        }
+        vector<Sample> buf(bufsize);
+        Timing t = measure(cfg, bufsize, [&vm, &buf, bufsize]()
+                           {
+                             std::fill(buf.begin(), buf.end(), 0.0);
+                             vm.tick(&buf[0], bufsize);
+                           });
+        fprintf(list.item(), "{\"voices\": %d, \"bufsize\": %d, \"threads\": %d, \"ns_per_sample\": %.3f, "
+                "\"ns_per_sample_median\": %.3f, \"ns_per_voice_sample\": %.3f}", voices, bufsize, cfg.threads,
+                t.best, t.median, t.best / voices);
+        vm.setNumThreads(0);
+      }
+    }
+    delete instr;
+  }
+
+  void printUsage(const char* progname)
+  {
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  -o <file>        write the JSON results to a file instead of stdout\n"
+            "  --fs <hz>        sample rate (default: 48000)\n"
+            "  --block <n>      block size for the unit and circuit benchmarks (default: 256)\n"
+            "  --reps <n>       repetitions of each measurement (default: 7)\n"
+            "  --samples <n>    samples rendered per repetition, at least (default: 200000)\n"
+            "  --threads <n>    worker threads for rendering voices and circuits (default: 0)\n"
+            "  --quick          fewer buffer sizes in the voice manager benchmark\n",
+            progname);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  BenchConfig cfg = { 48000.0, 256, 7, 200000.0, 0, false };
+  const char* outpath = nullptr;
+  for (int i = 1; i < argc; i++)
+  {
+    const char* arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (!strcmp(arg, "--quick"))
+      cfg.quick = true;
+    else if (!strcmp(arg, "-o") && hasValue)
+      outpath = argv[++i];
+    else if (!strcmp(arg, "--fs") && hasValue)
+      cfg.fs = atof(argv[++i]);
+    else if (!strcmp(arg, "--block") && hasValue)
+      cfg.bufsize = atoi(argv[++i]);
+    else if (!strcmp(arg, "--reps") && hasValue)
+      cfg.reps = atoi(argv[++i]);
+    else if (!strcmp(arg, "--samples") && hasValue)
+      cfg.minSamples = atof(argv[++i]);
+    else if (!strcmp(arg, "--threads") && hasValue)
+      cfg.threads = atoi(argv[++i]);
+    else
+    {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (cfg.fs <= 0 || cfg.bufsize <= 0 || cfg.reps <= 0 || cfg.minSamples <= 0 || cfg.threads < 0)
+  {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  FILE* out = outpath ? fopen(outpath, "w") : stdout;
+  if (!out)
+  {
+    fprintf(stderr, "error: unable to open %s\n", outpath);
+    return 1;
+  }
+  fprintf(out, "{\n");
+  fprintf(out, "  \"config\": {\"fs\": %.1f, \"bufsize\": %d, \"reps\": %d, \"samples\": %.0f, \"threads\": %d},\n",
+          cfg.fs, cfg.bufsize, cfg.reps, cfg.minSamples, cfg.threads);
+  benchUnits(cfg, out);
+  benchCircuits(cfg, out);
+  benchVoiceManager(cfg, out);
+  fprintf(out, "}\n");
+  if (outpath)
+    fclose(out);
+  return 0;
+}
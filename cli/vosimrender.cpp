@@ -0,0 +1,149 @@
+/**
+ * vosimrender: renders a MIDI file through a VOSIMSynth patch without a plugin host.
+ *
+ * The patch is the plugin state as written by CircuitPanel::serialize. Output is written as a 32 bit float WAV file,
+ * or as raw interleaved floats with --raw.
+ */
+#include "StandardUnits.h"
+#include "PatchLoader.h"
+#include "MidiFile.h"
+#include "OfflineRenderer.h"
+#include "VoiceManager.h"
+#include "tables.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace syn;
+using std::string;
+
+namespace
+{
+  void printUsage(const char* progname)
+  {
+    fprintf(stderr,
+            "usage: %s [options] <patch> <midifile>\n"
+            "  -o <file>        output file (default: out.wav)\n"
+            "  --raw            write raw interleaved 32 bit floats instead of WAV\n"
+            "  --fs <hz>        sample rate (default: 48000)\n"
+            "  --block <n>      block size in samples (default: 256)\n"
+            "  --voices <n>     polyphony, at most %d (default: 6)\n"
+            "  --threads <n>    voice rendering worker threads (default: hardware threads - 1)\n"
+            "  --channels <n>   number of output channels (default: 2)\n"
+            "  --tail <sec>     seconds rendered after the end of the MIDI file (default: 2)\n"
+            "  --offset <n>     byte offset of the patch within the patch file (default: 0)\n"
+            "  --oversampling <n>  render the voices at 1, 2, 4 or %d times the sample rate (default: as saved in the patch)\n"
+            "  --table-cache <file>  map the lookup tables from this file, generating and writing it if needed\n"
+            "  --sine-table <n>      points in the sine table, a power of two (default: 1024)\n"
+            "  --pitch-table <n>     points in the pitch table, a power of two (default: 256)\n"
+            "  --saw-oversampling <n>  points per period of the highest harmonic in the saw tables (default: 8)\n",
+            progname, MAX_VOICES, MAX_OVERSAMPLING);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  string outpath = "out.wav";
+  bool raw = false;
+  double fs = 48000.0;
+  int blocksize = 256;
+  int voices = 6;
+  int threads = int(std::thread::hardware_concurrency()) - 1;
+  int channels = 2;
+  double tail = 2.0;
+  long offset = 0;
+  int oversampling = 0;
+  TableConfig tableConfig;
+  string tableCache;
+  const char* positional[2] = {nullptr, nullptr};
+  int npositional = 0;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const char* arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (!strcmp(arg, "--raw"))
+      raw = true;
+    else if (!strcmp(arg, "-o") && hasValue)
+      outpath = argv[++i];
+    else if (!strcmp(arg, "--fs") && hasValue)
+      fs = atof(argv[++i]);
+    else if (!strcmp(arg, "--block") && hasValue)
+      blocksize = atoi(argv[++i]);
+    else if (!strcmp(arg, "--voices") && hasValue)
+      voices = atoi(argv[++i]);
+    else if (!strcmp(arg, "--threads") && hasValue)
+      threads = atoi(argv[++i]);
+    else if (!strcmp(arg, "--channels") && hasValue)
+      channels = atoi(argv[++i]);
+    else if (!strcmp(arg, "--tail") && hasValue)
+      tail = atof(argv[++i]);
+    else if (!strcmp(arg, "--offset") && hasValue)
+      offset = atol(argv[++i]);
+    else if (!strcmp(arg, "--oversampling") && hasValue)
+      oversampling = atoi(argv[++i]);
+    else if (!strcmp(arg, "--table-cache") && hasValue)
+      tableCache = argv[++i];
+    else if (!strcmp(arg, "--sine-table") && hasValue)
+      tableConfig.sineSize = atoi(argv[++i]);
+    else if (!strcmp(arg, "--pitch-table") && hasValue)
+      tableConfig.pitchSize = atoi(argv[++i]);
+    else if (!strcmp(arg, "--saw-oversampling") && hasValue)
+      tableConfig.blSawOversampling = atoi(argv[++i]);
+    else if (arg[0] != '-' && npositional < 2)
+      positional[npositional++] = arg;
+    else
+    {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (npositional != 2 || fs <= 0 || blocksize <= 0 || channels <= 0 || tail < 0 || offset < 0 || oversampling < 0)
+  {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  try
+  {
+    TableStore::configure(tableConfig, tableCache);
+    // build the tables now, so that the render time does not include them
+    TableStore::get();
+    UnitFactory factory;
+    registerStandardUnits(factory);
+    PatchLoader loader(factory);
+    Instrument* instr = loader.loadFile(positional[0], offset);
+
+    MidiFile midi;
+    midi.loadFile(positional[1]);
+
+    VoiceManager vm;
+    vm.setMaxVoices(voices, instr);
+    if (oversampling > 0)
+      vm.setOversampling(oversampling);
+    vm.setNumThreads(threads);
+
+    OfflineRenderer renderer(vm, fs, blocksize);
+    vector<vector<Sample>> samples;
+    renderer.render(midi.getEvents(), midi.getDuration(), tail, samples, channels);
+
+    if (raw)
+      OfflineRenderer::writeRaw(outpath, samples);
+    else
+      OfflineRenderer::writeWav(outpath, samples, fs);
+
+    printf("rendered %.3f s in %.3f s (%.1fx realtime) to %s\n", samples[0].size() / fs, renderer.getRenderTime(),
+           renderer.getRealtimeMultiple(), outpath.c_str());
+    vm.setNumThreads(0);
+    delete instr;
+  }
+  catch (std::exception& e)
+  {
+    fprintf(stderr, "error: %s\n", e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -1,74 +0,0 @@
-#include "tables.h"
-namespace syn {
-const double BL_SAW[256] = {
-0.000000000000000000,-0.208309941523236591,-0.406384266806087857,-0.584862831787605342,-0.736047386458373532,-0.854519747211163749,-0.937531077725545225,-0.985126747489251442,-1.000000000000000888,-0.987096773066693745,-0.953020157765250731,-0.905303229427942169,-0.851631127779940322,-0.799096075840775910,-0.753562390085159794,-0.719203435995645957,
--0.698250882560878527,-0.690971185034050195,-0.695858041591347454,-0.710005701660784139,-0.729609168905552163,-0.750525581248257301,-0.768827499556164362,-0.781283612014314843,-0.785714573218793233,-0.781189586512348599,-0.768050516309184972,-0.747772077160990478,-0.722686305592328049,-0.695614751674739074,-0.669460934507569383,-0.646817716721852287,
--0.629639400532017168,-0.619017435964268614,-0.615083293968589184,-0.617044425074659619,-0.623341641788911272,-0.631900980336912665,-0.640441987283805969,-0.646798706624865605,-0.649209932731614203,-0.646541273247712711,-0.638412233297979248,-0.625215311838602794,-0.608029064038117295,-0.588441212469931973,-0.568309344729289179,-0.549494089911679695,
--0.533602084209555572,-0.521773361271674729,-0.514540562261456502,-0.511776671986387210,-0.512735395432494467,-0.516175546238320293,-0.520549646414720679,-0.524228795672416870,-0.525731770603202420,-0.523926697334922808,-0.518178328004641586,-0.508422186401944920,-0.495157415824491853,-0.479361561987928841,-0.462341180027172116,-0.445540631485372540,
--0.430336630307724954,-0.417847375434729662,-0.408782389440868754,-0.403352933257854041,-0.401254024183463121,-0.401718920365588927,-0.403636875827291741,-0.405716397742863000,-0.406670301686548830,-0.405396325461594875,-0.401128209938601210,-0.393536756088391115,-0.382767720002173295,-0.369412444750575886,-0.354416568891133321,-0.338940682404948901,
--0.324193256034135846,-0.311259689858417565,-0.300951471762093747,-0.293696240350963145,-0.289483505934400753,-0.287872779923479261,-0.288062038824175470,-0.289006042706075328,-0.289567203016680652,-0.288677378918259175,-0.285487742171335990,-0.279485820435749377,-0.270563692480639439,-0.259028352451560473,-0.245553475548661998,-0.231080044384938205,
--0.216680385505142875,-0.203405141510623694,-0.192134893359342807,-0.183457272463210336,-0.177586615970974776,-0.174337078519112565,-0.173152500447005836,-0.173188324426428619,-0.173433573846545702,-0.172855370046413881,-0.170545432929388896,-0.165847886146890694,-0.158450469687020090,-0.148426538909302824,-0.136222243239361829,-0.122591035032247164,
--0.108485066860706539,-0.094919056414446687,-0.082825995065019711,-0.072925127687811328,-0.065620803509144107,-0.060946360661115806,-0.058560795403505589,-0.057798489435419355,-0.057764780138904362,-0.057463711523689481,-0.055939801065831081,-0.052413727003437084,-0.046392746778603597,-0.037740266184459560,-0.026694777226457796,-0.013835551074761991,
-0.000000000000000000,0.013835551074762340,0.026694777226458112,0.037740266184459942,0.046392746778603916,0.052413727003437466,0.055939801065831588,0.057463711523689863,0.057764780138904806,0.057798489435419792,0.058560795403505776,0.060946360661116125,0.065620803509144301,0.072925127687811633,0.082825995065019975,0.094919056414447062,
-0.108485066860706927,0.122591035032247483,0.136222243239362190,0.148426538909303241,0.158450469687020395,0.165847886146891277,0.170545432929389229,0.172855370046414047,0.173433573846545896,0.173188324426429119,0.173152500447005947,0.174337078519112759,0.177586615970975081,0.183457272463210752,0.192134893359343223,0.203405141510623833,
-0.216680385505143264,0.231080044384938621,0.245553475548662303,0.259028352451560751,0.270563692480639661,0.279485820435749877,0.285487742171336489,0.288677378918259342,0.289567203016681041,0.289006042706075716,0.288062038824175692,0.287872779923479316,0.289483505934401031,0.293696240350963422,0.300951471762093969,0.311259689858417843,
-0.324193256034136235,0.338940682404949123,0.354416568891133599,0.369412444750576274,0.382767720002173517,0.393536756088391615,0.401128209938601654,0.405396325461595097,0.406670301686549329,0.405716397742863388,0.403636875827291908,0.401718920365588927,0.401254024183463287,0.403352933257854263,0.408782389440868810,0.417847375434729718,
-0.430336630307724954,0.445540631485372596,0.462341180027172172,0.479361561987928841,0.495157415824491909,0.508422186401945031,0.518178328004641697,0.523926697334922697,0.525731770603202087,0.524228795672416759,0.520549646414720346,0.516175546238319849,0.512735395432494356,0.511776671986386877,0.514540562261456391,0.521773361271674618,
-0.533602084209555128,0.549494089911679584,0.568309344729288957,0.588441212469931862,0.608029064038116851,0.625215311838602794,0.638412233297979137,0.646541273247712378,0.649209932731613759,0.646798706624865272,0.640441987283805303,0.631900980336911888,0.623341641788910827,0.617044425074659286,0.615083293968588962,0.619017435964268281,
-0.629639400532016613,0.646817716721852287,0.669460934507569383,0.695614751674739074,0.722686305592328271,0.747772077160990811,0.768050516309185194,0.781189586512348821,0.785714573218793566,0.781283612014314732,0.768827499556164362,0.750525581248257190,0.729609168905552163,0.710005701660783917,0.695858041591347010,0.690971185034049862,
-0.698250882560878194,0.719203435995645513,0.753562390085159239,0.799096075840775466,0.851631127779939434,0.905303229427941614,0.953020157765250064,0.987096773066693078,1.000000000000000000,0.985126747489250554,0.937531077725544226,0.854519747211162528,0.736047386458372643,0.584862831787604232,0.406384266806086747,0.208309941523235481,
-};
-const double PITCH_TABLE[256] = {
-0.005029717360120691,0.005330007127586568,0.005648225127990476,0.005985441732590796,0.006342791217138595,0.006721475577174580,0.007122768571111110,0.007548020004698797,0.007998660271289124,0.008476205163164781,0.008982260970121444,0.009518529882450730,0.010086815716497980,0.010689029982053778,0.011327198311987467,0.012003467275749868,
-0.012720111599663270,0.013479541818285180,0.014284312382582312,0.015137130252187743,0.016040864000642561,0.016998553464248747,0.018013419966988624,0.019088877155903586,0.020228542483379051,0.021436249374957094,0.022716060123605591,0.024072279553815256,0.025509469501485652,0.027032464158305725,0.028646386332241255,0.030356664678824131,
-0.032169051961203142,0.034089644400376623,0.036124902180694092,0.038281671179600199,0.040567205994711843,0.042989194345683518,0.045555782932939881,0.048275604840254810,0.051157808573350214,0.054212088832188962,0.057448719120469574,0.060878586302009388,0.064513227220250366,0.068364867504064911,0.072446462690387375,0.076771741801995280,
-0.081355253527019583,0.086212415155515115,0.091359564437696647,0.096814014538272750,0.102594112271724380,0.108719299814410655,0.115210180101079390,0.122088586125752060,0.129377654380088303,0.137101902676248028,0.145287312616020847,0.153961416983619148,0.163153392356091859,0.172894157242869523,0.183216476084543806,0.194155069460698160,
-0.205746730877489015,0.218030450527808062,0.231047546440311752,0.244841803458455104,0.259459620517006717,0.274950166711429134,0.291365546685086296,0.308760975890581990,0.327194966314746760,0.346729523291980757,0.367430354067967868,0.389367088815291085,0.412613514844367868,0.437247824797506068,0.463352879660917982,0.491016487479366548,
-0.520331698710947976,0.551397119215468301,0.584317241929201425,0.619202798341662697,0.656171130956634152,0.695346587990279597,0.736860941633956545,0.780853831288622513,0.827473233261713070,0.876875958506384556,0.929228180077335986,0.984705992077387182,1.043496001974897114,1.105795958284389480,1.171815415721648712,1.241776440070647025,
-1.315914355133228186,1.394478534273998926,1.477733239222916106,1.565958508956998729,1.659451101651038929,1.758525492865703699,1.863514933330563617,1.974772569880064443,2.092672633312862462,2.217611697170049467,2.350010011666358256,2.490312917261205516,2.638992342624322252,2.796548392034595487,2.963511027551555710,3.140441851617713720,
-3.327935996087844295,3.526624124039144270,3.737174551095716613,3.960295493402702149,4.196737449811465126,4.447295726288650997,4.712813111040301095,4.994182709349193949,5.292350947660816374,5.608320757022577929,5.943154946584264131,6.297979778506962667,6.673988756305123005,7.072446639364509124,7.494693697139273247,7.942150217337839102,
-8.416321283261552821,8.918801836365251035,9.451282041068459705,10.015552969862509869,10.613512627836216851,11.247172336884501576,11.918663501074021838,12.630244775922367495,13.384309665705323766,14.183394574347085282,15.030187336973664713,15.927536260826530068,16.878459705946962544,17.886156237856930318,18.954015386386799946,20.085629046838320733,
-21.284803561832578822,22.555572524481842578,23.902210345950567927,25.329246633042000525,26.841481424171398373,28.444001334974281292,30.142196667857469095,31.941779543044003020,33.848803112097357371,35.869681918552998923,38.011213474142991231,40.280601123188205293,42.685478272066006866,45.233934065252128676,47.934540594302781358,50.796381731296889939,
-53.829083683724888942,57.042847373599322225,60.448482749698982275,64.057445148360798726,67.881873825124017685,71.934632786833546447,76.229354061546104049,80.780483551785749796,85.603329625379984691,90.714114607320453842,96.130029345847930244,101.869291036302001885,107.951204497234840574,114.396227104898457583,121.226037604524464086,128.463609029849806120,
-136.133285976165353759,144.260866486806065723,152.873688828518993432,162.000723447590559090,171.672670416040773489,181.922062695658524945,192.783375567219366076,204.293142592970838223,216.490078502436006147,229.415209414882667716,243.112010836479356612,257.626553896309701486,273.007660313133044383,289.307066614139671401,306.579598158081182646,324.883353548118236631,
-344.279900054691211153,364.834480705743430917,386.616233740874747582,409.698425167590244200,434.158695201880902914,460.079319422072956058,487.547485514371544468,516.655586540980721111,547.501531717235025098,580.189075743095372673,614.828167796760112651,651.535321364277706380,690.434006149141055175,731.655063380095384673,775.337145914126153912,821.627184614953421260,
-870.680882575775967780,922.663238848652326851,977.749103442150158116,1036.123765454085969395,1097.983576317615415974,1163.536610257054235262,1233.003364174960552191,1306.617499324665459426,1384.626627262946612973,1467.293142726525957187,1554.895106233885144320,1647.727179381151927373,1746.101615978064955925,1850.349312357819826502,1960.820920393711503493,2077.888026966301367793,
-2201.944403848453930550,2333.407332212399523996,2472.719006213981629116,2620.348020375253327074,2776.790945768434994534,2942.574000302968215692,3118.254818733868887648,3304.424328345135108975,3501.708736617239992484,3710.771637564577758894,3932.316243827800917643,4167.087752029010516708,4415.875849346014547336,4679.517369736829095928,4958.899108749114930106,5254.960806382415285043,
-5568.698308036584421643,5901.166914178659681056,6253.484929995260245050,6626.837426970274464111,7022.480229040432277543,7441.744136736773725715,7886.039403520435371320,8356.860479369726817822,8855.791037573993889964,9384.509301642747232108,9944.793690247841368546,10538.528799186244214070,11167.711740484610345447,11834.458859967997341300,12541.012855888555350248,13289.750322558245898108,
-};
-const double SIN[1024] = {
-0.000000000000000000,0.006135884649154475,0.012271538285719925,0.018406729905804820,0.024541228522912288,0.030674803176636626,0.036807222941358832,0.042938256934940820,0.049067674327418015,0.055195244349689934,0.061320736302208578,0.067443919563664051,0.073564563599667426,0.079682437971430126,0.085797312344439894,0.091908956497132724,0.098017140329560604,0.104121633872054586,0.110222207293883059,0.116318630911904752,0.122410675199216196,0.128498110793793169,0.134580708507126168,0.140658239332849211,0.146730474455361748,0.152797185258443435,0.158858143333861446,0.164913120489969894,0.170961888760301217,0.177004220412148749,0.183039887955140951,0.189068664149806193,
-0.195090322016128248,0.201104634842091901,0.207111376192218560,0.213110319916091362,0.219101240156869798,0.225083911359792832,0.231058108280671110,0.237023605994367198,0.242980179903263871,0.248927605745720149,0.254865659604514572,0.260794117915275514,0.266712757474898365,0.272621355449948977,0.278519689385053060,0.284407537211271877,0.290284677254462331,0.296150888243623789,0.302005949319228084,0.307849640041534867,0.313681740398891518,0.319502030816015692,0.325310292162262926,0.331106305759876429,0.336889853392220051,0.342660717311994378,0.348418680249434565,0.354163525420490344,0.359895036534988111,0.365612997804773854,0.371317193951837543,0.377007410216418259,
-0.382683432365089782,0.388345046698826246,0.393992040061048099,0.399624199845646788,0.405241314004989861,0.410843171057903911,0.416429560097637153,0.422000270799799682,0.427555093430282085,0.433093818853151957,0.438616238538527659,0.444122144570429200,0.449611329654606540,0.455083587126343836,0.460538710958240005,0.465976495767966181,0.471396736825997642,0.476799230063322088,0.482183772079122663,0.487550160148435996,0.492898192229784038,0.498227666972781813,0.503538383725717464,0.508830142543106989,0.514102744193221661,0.519355990165589643,0.524589682678468949,0.529803624686294605,0.534997619887097153,0.540171472729892854,0.545324988422046464,0.550457972936604811,
-0.555570233019602178,0.560661576197336031,0.565731810783613120,0.570780745886967256,0.575808191417845339,0.580813958095764526,0.585797857456438864,0.590759701858874164,0.595699304492433357,0.600616479383868973,0.605511041404325545,0.610382806276309475,0.615231590580626819,0.620057211763289096,0.624859488142386343,0.629638238914926984,0.634393284163645488,0.639124444863775731,0.643831542889791386,0.648514401022112441,0.653172842953776756,0.657806693297078637,0.662415777590171784,0.666999922303637471,0.671558954847018330,0.676092703575315923,0.680600997795453022,0.685083667772700355,0.689540544737066829,0.693971460889653891,0.698376249408972916,0.702754744457225300,
-0.707106781186547462,0.711432195745216434,0.715730825283818595,0.720002507961381655,0.724247082951466892,0.728464390448225196,0.732654271672412816,0.736816568877369793,0.740951125354959106,0.745057785441465947,0.749136394523459259,0.753186799043612520,0.757208846506484567,0.761202385484261779,0.765167265622458959,0.769103337645579588,0.773010453362736882,0.776888465673232442,0.780737228572094488,0.784556597155575242,0.788346427626606228,0.792106577300212278,0.795836904608883455,0.799537269107905013,0.803207531480644832,0.806847553543799223,0.810457198252594768,0.814036329705948303,0.817584813151583711,0.821102514991104648,0.824589302785025291,0.828045045257755796,
-0.831469612302545236,0.834862874986380010,0.838224705554837968,0.841554977436898333,0.844853565249707006,0.848120344803297121,0.851355193105265196,0.854557988365400534,0.857728610000272118,0.860866938637767309,0.863972856121586696,0.867046245515692648,0.870086991108711350,0.873094978418290091,0.876070094195406601,0.879012226428633414,0.881921264348354939,0.884797098430937790,0.887639620402853935,0.890448723244757878,0.893224301195515324,0.895966249756185107,0.898674465693953817,0.901348847046022028,0.903989293123443338,0.906595704514915335,0.909167983090522269,0.911706032005429878,0.914209755703530691,0.916679059921042705,0.919113851690057770,0.921514039342041902,
-0.923879532511286738,0.926210242138311268,0.928506080473215589,0.930766961078983712,0.932992798834738846,0.935183509938947499,0.937339011912574960,0.939459223602189919,0.941544065183020806,0.943593458161960386,0.945607325380521280,0.947585591017741091,0.949528180593036675,0.951435020969008338,0.953306040354193751,0.955141168305770671,0.956940335732208935,0.958703474895871599,0.960430519415565787,0.962121404269041580,0.963776065795439840,0.965394441697689398,0.966976471044852071,0.968522094274417267,0.970031253194543974,0.971503890986251784,0.972939952205560066,0.974339382785575858,0.975702130038528570,0.977028142657754395,0.978317370719627655,0.979569765685440519,
-0.980785280403230431,0.981963869109555243,0.983105487431216285,0.984210092386929025,0.985277642388941222,0.986308097244598669,0.987301418157858435,0.988257567730749464,0.989176509964781014,0.990058210262297123,0.990902635427780010,0.991709753669099525,0.992479534598709967,0.993211949234794500,0.993906970002356061,0.994564570734255415,0.995184726672196818,0.995767414467659817,0.996312612182778001,0.996820299291165668,0.997290456678690207,0.997723066644191636,0.998118112900149179,0.998475580573294774,0.998795456205172405,0.999077727752645361,0.999322384588349544,0.999529417501093143,0.999698818696204250,0.999830581795823403,0.999924701839144503,0.999981175282601109,
-1.000000000000000000,0.999981175282601109,0.999924701839144503,0.999830581795823403,0.999698818696204250,0.999529417501093143,0.999322384588349544,0.999077727752645361,0.998795456205172405,0.998475580573294774,0.998118112900149179,0.997723066644191636,0.997290456678690207,0.996820299291165779,0.996312612182778001,0.995767414467659817,0.995184726672196929,0.994564570734255415,0.993906970002356061,0.993211949234794500,0.992479534598709967,0.991709753669099525,0.990902635427780010,0.990058210262297123,0.989176509964781014,0.988257567730749464,0.987301418157858435,0.986308097244598669,0.985277642388941222,0.984210092386929025,0.983105487431216285,0.981963869109555243,
-0.980785280403230431,0.979569765685440519,0.978317370719627655,0.977028142657754395,0.975702130038528570,0.974339382785575858,0.972939952205560177,0.971503890986251784,0.970031253194543974,0.968522094274417378,0.966976471044852071,0.965394441697689398,0.963776065795439840,0.962121404269041580,0.960430519415565898,0.958703474895871599,0.956940335732208935,0.955141168305770671,0.953306040354193862,0.951435020969008338,0.949528180593036675,0.947585591017741202,0.945607325380521391,0.943593458161960386,0.941544065183020806,0.939459223602189919,0.937339011912574960,0.935183509938947610,0.932992798834738846,0.930766961078983712,0.928506080473215589,0.926210242138311379,
-0.923879532511286738,0.921514039342042013,0.919113851690057770,0.916679059921042705,0.914209755703530691,0.911706032005429878,0.909167983090522491,0.906595704514915335,0.903989293123443449,0.901348847046022028,0.898674465693953928,0.895966249756185218,0.893224301195515213,0.890448723244757989,0.887639620402853935,0.884797098430937901,0.881921264348355050,0.879012226428633525,0.876070094195406601,0.873094978418290202,0.870086991108711461,0.867046245515692759,0.863972856121586807,0.860866938637767198,0.857728610000272118,0.854557988365400534,0.851355193105265196,0.848120344803297233,0.844853565249707228,0.841554977436898444,0.838224705554838190,0.834862874986380121,
-0.831469612302545347,0.828045045257755796,0.824589302785025180,0.821102514991104759,0.817584813151583711,0.814036329705948525,0.810457198252594768,0.806847553543799445,0.803207531480644943,0.799537269107905235,0.795836904608883566,0.792106577300212278,0.788346427626606339,0.784556597155575131,0.780737228572094599,0.776888465673232442,0.773010453362737104,0.769103337645579588,0.765167265622459070,0.761202385484261890,0.757208846506484679,0.753186799043612520,0.749136394523459259,0.745057785441466058,0.740951125354958995,0.736816568877370015,0.732654271672412816,0.728464390448225307,0.724247082951466892,0.720002507961381766,0.715730825283818706,0.711432195745216656,
-0.707106781186547573,0.702754744457225189,0.698376249408972916,0.693971460889654002,0.689540544737067052,0.685083667772700355,0.680600997795453244,0.676092703575315923,0.671558954847018552,0.666999922303637582,0.662415777590172006,0.657806693297078748,0.653172842953776644,0.648514401022112552,0.643831542889791386,0.639124444863775842,0.634393284163645488,0.629638238914927206,0.624859488142386454,0.620057211763289429,0.615231590580626930,0.610382806276309697,0.605511041404325656,0.600616479383868862,0.595699304492433468,0.590759701858874164,0.585797857456438975,0.580813958095764526,0.575808191417845450,0.570780745886967367,0.565731810783613454,0.560661576197336142,
-0.555570233019602178,0.550457972936604922,0.545324988422046353,0.540171472729892965,0.534997619887097153,0.529803624686294827,0.524589682678468949,0.519355990165589754,0.514102744193221772,0.508830142543107322,0.503538383725717575,0.498227666972781758,0.492898192229784149,0.487550160148435885,0.482183772079122885,0.476799230063322088,0.471396736825997809,0.465976495767966181,0.460538710958240227,0.455083587126343891,0.449611329654606873,0.444122144570429311,0.438616238538527548,0.433093818853152068,0.427555093430282029,0.422000270799799848,0.416429560097637153,0.410843171057904133,0.405241314004989917,0.399624199845647066,0.393992040061048154,0.388345046698826579,
-0.382683432365089893,0.377007410216418148,0.371317193951837710,0.365612997804773798,0.359895036534988333,0.354163525420490399,0.348418680249434787,0.342660717311994434,0.336889853392220329,0.331106305759876485,0.325310292162263259,0.319502030816015803,0.313681740398891407,0.307849640041535033,0.302005949319228029,0.296150888243624011,0.290284677254462387,0.284407537211272099,0.278519689385053171,0.272621355449949254,0.266712757474898476,0.260794117915275847,0.254865659604514683,0.248927605745720093,0.242980179903264065,0.237023605994367170,0.231058108280671332,0.225083911359792832,0.219101240156870047,0.213110319916091417,0.207111376192218838,0.201104634842092012,
-0.195090322016128609,0.189068664149806359,0.183039887955140895,0.177004220412148944,0.170961888760301217,0.164913120489970144,0.158858143333861473,0.152797185258443685,0.146730474455361803,0.140658239332849544,0.134580708507126279,0.128498110793793086,0.122410675199216348,0.116318630911904711,0.110222207293883240,0.104121633872054573,0.098017140329560826,0.091908956497132752,0.085797312344440158,0.079682437971430195,0.073564563599667732,0.067443919563664176,0.061320736302208488,0.055195244349690094,0.049067674327417966,0.042938256934941021,0.036807222941358832,0.030674803176636865,0.024541228522912326,0.018406729905805101,0.012271538285720007,0.006135884649154799,
-0.000000000000000122,-0.006135884649154554,-0.012271538285719762,-0.018406729905804858,-0.024541228522912080,-0.030674803176636619,-0.036807222941358582,-0.042938256934940779,-0.049067674327417724,-0.055195244349689851,-0.061320736302208245,-0.067443919563663926,-0.073564563599667496,-0.079682437971429945,-0.085797312344439922,-0.091908956497132516,-0.098017140329560590,-0.104121633872054323,-0.110222207293883004,-0.116318630911904475,-0.122410675199216099,-0.128498110793792836,-0.134580708507126057,-0.140658239332849294,-0.146730474455361581,-0.152797185258443435,-0.158858143333861224,-0.164913120489969894,-0.170961888760300967,-0.177004220412148694,-0.183039887955140645,-0.189068664149806109,
--0.195090322016128359,-0.201104634842091762,-0.207111376192218588,-0.213110319916091195,-0.219101240156869798,-0.225083911359792610,-0.231058108280671082,-0.237023605994366948,-0.242980179903263815,-0.248927605745719871,-0.254865659604514461,-0.260794117915275625,-0.266712757474898254,-0.272621355449949032,-0.278519689385052893,-0.284407537211271821,-0.290284677254462109,-0.296150888243623789,-0.302005949319227807,-0.307849640041534811,-0.313681740398891185,-0.319502030816015581,-0.325310292162262982,-0.331106305759876263,-0.336889853392220107,-0.342660717311994212,-0.348418680249434565,-0.354163525420490122,-0.359895036534988111,-0.365612997804773576,-0.371317193951837432,-0.377007410216417926,
--0.382683432365089615,-0.388345046698826357,-0.393992040061047932,-0.399624199845646844,-0.405241314004989694,-0.410843171057903911,-0.416429560097636930,-0.422000270799799626,-0.427555093430281807,-0.433093818853151846,-0.438616238538527325,-0.444122144570429089,-0.449611329654606651,-0.455083587126343669,-0.460538710958240061,-0.465976495767965959,-0.471396736825997642,-0.476799230063321922,-0.482183772079122663,-0.487550160148435663,-0.492898192229783927,-0.498227666972781535,-0.503538383725717464,-0.508830142543107100,-0.514102744193221550,-0.519355990165589532,-0.524589682678468727,-0.529803624686294605,-0.534997619887096931,-0.540171472729892854,-0.545324988422046131,-0.550457972936604700,
--0.555570233019601956,-0.560661576197335920,-0.565731810783613231,-0.570780745886967145,-0.575808191417845228,-0.580813958095764304,-0.585797857456438864,-0.590759701858873942,-0.595699304492433246,-0.600616479383868640,-0.605511041404325434,-0.610382806276309475,-0.615231590580626708,-0.620057211763289207,-0.624859488142386232,-0.629638238914926984,-0.634393284163645266,-0.639124444863775731,-0.643831542889791275,-0.648514401022112330,-0.653172842953776533,-0.657806693297078526,-0.662415777590171784,-0.666999922303637360,-0.671558954847018441,-0.676092703575315812,-0.680600997795453022,-0.685083667772700133,-0.689540544737066829,-0.693971460889653780,-0.698376249408972694,-0.702754744457225078,
--0.707106781186547462,-0.711432195745216434,-0.715730825283818484,-0.720002507961381655,-0.724247082951466781,-0.728464390448225196,-0.732654271672412705,-0.736816568877369793,-0.740951125354958884,-0.745057785441465836,-0.749136394523459037,-0.753186799043612409,-0.757208846506484234,-0.761202385484262001,-0.765167265622458959,-0.769103337645579477,-0.773010453362736660,-0.776888465673232553,-0.780737228572094377,-0.784556597155575020,-0.788346427626605895,-0.792106577300212389,-0.795836904608883455,-0.799537269107904791,-0.803207531480645054,-0.806847553543799223,-0.810457198252594657,-0.814036329705948081,-0.817584813151583822,-0.821102514991104648,-0.824589302785025069,-0.828045045257755463,
--0.831469612302545236,-0.834862874986379899,-0.838224705554837857,-0.841554977436898555,-0.844853565249707117,-0.848120344803297121,-0.851355193105264862,-0.854557988365400534,-0.857728610000272007,-0.860866938637767087,-0.863972856121586474,-0.867046245515692648,-0.870086991108711350,-0.873094978418289869,-0.876070094195406712,-0.879012226428633414,-0.881921264348354939,-0.884797098430937567,-0.887639620402854046,-0.890448723244757878,-0.893224301195515213,-0.895966249756184885,-0.898674465693953817,-0.901348847046021917,-0.903989293123443116,-0.906595704514915446,-0.909167983090522380,-0.911706032005429767,-0.914209755703530469,-0.916679059921042705,-0.919113851690057659,-0.921514039342041791,
--0.923879532511286516,-0.926210242138311379,-0.928506080473215478,-0.930766961078983601,-0.932992798834738957,-0.935183509938947610,-0.937339011912574849,-0.939459223602189697,-0.941544065183020806,-0.943593458161960275,-0.945607325380521169,-0.947585591017741202,-0.949528180593036675,-0.951435020969008338,-0.953306040354193640,-0.955141168305770782,-0.956940335732208824,-0.958703474895871488,-0.960430519415565676,-0.962121404269041580,-0.963776065795439840,-0.965394441697689287,-0.966976471044852182,-0.968522094274417267,-0.970031253194543974,-0.971503890986251673,-0.972939952205560177,-0.974339382785575858,-0.975702130038528459,-0.977028142657754284,-0.978317370719627655,-0.979569765685440519,
--0.980785280403230320,-0.981963869109555354,-0.983105487431216285,-0.984210092386929025,-0.985277642388941111,-0.986308097244598669,-0.987301418157858324,-0.988257567730749464,-0.989176509964780903,-0.990058210262297123,-0.990902635427780010,-0.991709753669099525,-0.992479534598710078,-0.993211949234794500,-0.993906970002356061,-0.994564570734255415,-0.995184726672196929,-0.995767414467659817,-0.996312612182778001,-0.996820299291165668,-0.997290456678690207,-0.997723066644191636,-0.998118112900149179,-0.998475580573294774,-0.998795456205172405,-0.999077727752645361,-0.999322384588349433,-0.999529417501093143,-0.999698818696204250,-0.999830581795823403,-0.999924701839144503,-0.999981175282601109,
--1.000000000000000000,-0.999981175282601109,-0.999924701839144503,-0.999830581795823403,-0.999698818696204250,-0.999529417501093143,-0.999322384588349544,-0.999077727752645361,-0.998795456205172405,-0.998475580573294774,-0.998118112900149179,-0.997723066644191636,-0.997290456678690207,-0.996820299291165668,-0.996312612182778001,-0.995767414467659817,-0.995184726672196929,-0.994564570734255415,-0.993906970002356061,-0.993211949234794611,-0.992479534598710078,-0.991709753669099525,-0.990902635427780010,-0.990058210262297123,-0.989176509964780903,-0.988257567730749464,-0.987301418157858435,-0.986308097244598780,-0.985277642388941222,-0.984210092386929136,-0.983105487431216396,-0.981963869109555354,
--0.980785280403230431,-0.979569765685440630,-0.978317370719627766,-0.977028142657754284,-0.975702130038528570,-0.974339382785575969,-0.972939952205560288,-0.971503890986251784,-0.970031253194543974,-0.968522094274417378,-0.966976471044852293,-0.965394441697689398,-0.963776065795439951,-0.962121404269041691,-0.960430519415565787,-0.958703474895871599,-0.956940335732208935,-0.955141168305770893,-0.953306040354193862,-0.951435020969008449,-0.949528180593036786,-0.947585591017741313,-0.945607325380521280,-0.943593458161960386,-0.941544065183020917,-0.939459223602189808,-0.937339011912574960,-0.935183509938947721,-0.932992798834739068,-0.930766961078983712,-0.928506080473215589,-0.926210242138311490,
--0.923879532511286627,-0.921514039342041902,-0.919113851690057881,-0.916679059921042816,-0.914209755703530580,-0.911706032005429878,-0.909167983090522491,-0.906595704514915557,-0.903989293123443338,-0.901348847046022139,-0.898674465693954039,-0.895966249756184996,-0.893224301195515324,-0.890448723244757989,-0.887639620402854157,-0.884797098430937679,-0.881921264348355050,-0.879012226428633636,-0.876070094195406934,-0.873094978418290091,-0.870086991108711461,-0.867046245515692870,-0.863972856121586585,-0.860866938637767309,-0.857728610000272229,-0.854557988365400756,-0.851355193105265085,-0.848120344803297344,-0.844853565249707228,-0.841554977436898777,-0.838224705554837968,-0.834862874986380121,
--0.831469612302545458,-0.828045045257755685,-0.824589302785025291,-0.821102514991104870,-0.817584813151583933,-0.814036329705948303,-0.810457198252594879,-0.806847553543799445,-0.803207531480645276,-0.799537269107905013,-0.795836904608883677,-0.792106577300212611,-0.788346427626606117,-0.784556597155575242,-0.780737228572094710,-0.776888465673232775,-0.773010453362736882,-0.769103337645579699,-0.765167265622459181,-0.761202385484262223,-0.757208846506484567,-0.753186799043612631,-0.749136394523459592,-0.745057785441465836,-0.740951125354959106,-0.736816568877370126,-0.732654271672413149,-0.728464390448225085,-0.724247082951467003,-0.720002507961381877,-0.715730825283819039,-0.711432195745216434,
--0.707106781186547684,-0.702754744457225633,-0.698376249408972694,-0.693971460889654113,-0.689540544737067163,-0.685083667772700800,-0.680600997795453022,-0.676092703575316034,-0.671558954847018663,-0.666999922303638026,-0.662415777590171784,-0.657806693297078859,-0.653172842953777089,-0.648514401022112330,-0.643831542889791497,-0.639124444863775953,-0.634393284163645932,-0.629638238914926984,-0.624859488142386454,-0.620057211763289429,-0.615231590580627374,-0.610382806276309475,-0.605511041404325656,-0.600616479383869306,-0.595699304492433246,-0.590759701858874275,-0.585797857456439086,-0.580813958095764971,-0.575808191417845228,-0.570780745886967367,-0.565731810783613565,-0.560661576197336586,
--0.555570233019602178,-0.550457972936605033,-0.545324988422046797,-0.540171472729892743,-0.534997619887097264,-0.529803624686294938,-0.524589682678469393,-0.519355990165589532,-0.514102744193221883,-0.508830142543107433,-0.503538383725718131,-0.498227666972781869,-0.492898192229784260,-0.487550160148436384,-0.482183772079122608,-0.476799230063322199,-0.471396736825997920,-0.465976495767966681,-0.460538710958239950,-0.455083587126344002,-0.449611329654606984,-0.444122144570429811,-0.438616238538527659,-0.433093818853152179,-0.427555093430282529,-0.422000270799799571,-0.416429560097637264,-0.410843171057904244,-0.405241314004990416,-0.399624199845646788,-0.393992040061048265,-0.388345046698826690,
--0.382683432365090392,-0.377007410216418259,-0.371317193951837821,-0.365612997804774353,-0.359895036534988000,-0.354163525420490510,-0.348418680249434898,-0.342660717311994989,-0.336889853392219996,-0.331106305759876596,-0.325310292162263370,-0.319502030816015470,-0.313681740398891518,-0.307849640041535144,-0.302005949319228584,-0.296150888243623733,-0.290284677254462498,-0.284407537211272210,-0.278519689385053670,-0.272621355449948977,-0.266712757474898587,-0.260794117915275958,-0.254865659604514405,-0.248927605745720204,-0.242980179903264176,-0.237023605994367725,-0.231058108280670998,-0.225083911359792971,-0.219101240156870158,-0.213110319916091973,-0.207111376192218533,-0.201104634842092123,
--0.195090322016128720,-0.189068664149806026,-0.183039887955141006,-0.177004220412149055,-0.170961888760301772,-0.164913120489969811,-0.158858143333861584,-0.152797185258443796,-0.146730474455362359,-0.140658239332849211,-0.134580708507126418,-0.128498110793793641,-0.122410675199216029,-0.116318630911904836,-0.110222207293883365,-0.104121633872055128,-0.098017140329560506,-0.091908956497132877,-0.085797312344440282,-0.079682437971430750,-0.073564563599667412,-0.067443919563664287,-0.061320736302209057,-0.055195244349689775,-0.049067674327418091,-0.042938256934941139,-0.036807222941359394,-0.030674803176636543,-0.024541228522912448,-0.018406729905805226,-0.012271538285720572,-0.006135884649154477,
-};
-
-}
@@ -1,13 +1,337 @@
 #include "tables.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SYN_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SYN_TARGET_AVX2
+#else
+#define SYN_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
 namespace syn
 {
+  namespace
+  {
+    /**
+     * Arguments shared by the interpolation kernels. Only valid for tables with the power-of-two, guard point padded
+     * layout, so the index of the next point is always idx+1.
+     */
+    struct LerpArgs
+    {
+      const double* table;
+      int mask;
+      double span; //!< index that a phase of 1 maps to: the size of a periodic table, the last index of any other
+      bool periodic;
+      bool normalize;
+      double bias;
+      double scale;
+    };
+
+    typedef void(*LerpKernel)(const LerpArgs& args, const double* phases, double* out, size_t n);
+    typedef void(*LerpKernelF)(const LerpArgs& args, const float* phases, float* out, size_t n);
+
+    inline double lerp_scalar(const LerpArgs& args, double phase)
+    {
+      if (args.normalize)
+      {
+        phase = (phase - args.bias)*args.scale;
+      }
+      double x = phase * args.span;
+      if (!args.periodic)
+      {
+        x = x < 0 ? 0 : (x > args.span ? args.span : x);
+      }
+      double fl = std::floor(x);
+      int int_index = int(fl) & args.mask;
+      double frac_index = x - fl;
+      return LERP(args.table[int_index], args.table[int_index + 1], frac_index);
+    }
+
+    template<typename T>
+    void lerp_kernel_scalar(const LerpArgs& args, const T* phases, T* out, size_t n)
+    {
+      for (int i = 0; i < n; i++)
+      {
+        out[i] = T(lerp_scalar(args, phases[i]));
+      }
+    }
+
+#ifdef SYN_X86
+    void lerp_kernel_sse2(const LerpArgs& args, const double* phases, double* out, size_t n)
+    {
+      const __m128d bias = _mm_set1_pd(args.bias);
+      const __m128d scale = _mm_set1_pd(args.scale);
+      const __m128d size = _mm_set1_pd(args.span);
+      const __m128d zero = _mm_setzero_pd();
+      const __m128d one = _mm_set1_pd(1.0);
+      const __m128i mask = _mm_set1_epi32(args.mask);
+      size_t i = 0;
+      for (; i + 2 <= n; i += 2)
+      {
+        __m128d x = _mm_loadu_pd(phases + i);
+        if (args.normalize)
+        {
+          x = _mm_mul_pd(_mm_sub_pd(x, bias), scale);
+        }
+        x = _mm_mul_pd(x, size);
+        if (!args.periodic)
+        {
+          x = _mm_min_pd(_mm_max_pd(x, zero), size);
+        }
+        // floor without SSE4.1: truncate, then step down where truncation rounded up
+        __m128d fl = _mm_cvtepi32_pd(_mm_cvttpd_epi32(x));
+        fl = _mm_sub_pd(fl, _mm_and_pd(_mm_cmpgt_pd(fl, x), one));
+        __m128i idx = _mm_and_si128(_mm_cvttpd_epi32(fl), mask);
+        __m128d frac = _mm_sub_pd(x, fl);
+        // guard point layout: table[idx] and table[idx+1] are adjacent, so each lane needs a single load
+        __m128d p0 = _mm_loadu_pd(args.table + _mm_cvtsi128_si32(idx));
+        __m128d p1 = _mm_loadu_pd(args.table + _mm_cvtsi128_si32(_mm_shuffle_epi32(idx, 1)));
+        __m128d a = _mm_unpacklo_pd(p0, p1);
+        __m128d b = _mm_unpackhi_pd(p0, p1);
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_mul_pd(_mm_sub_pd(b, a), frac), a));
+      }
+      for (; i < n; i++)
+      {
+        out[i] = lerp_scalar(args, phases[i]);
+      }
+    }
+
+    void lerp_kernel_sse2_f(const LerpArgs& args, const float* phases, float* out, size_t n)
+    {
+      const __m128 bias = _mm_set1_ps(float(args.bias));
+      const __m128 scale = _mm_set1_ps(float(args.scale));
+      const __m128 size = _mm_set1_ps(float(args.span));
+      const __m128 zero = _mm_setzero_ps();
+      const __m128 one = _mm_set1_ps(1.0f);
+      const __m128i mask = _mm_set1_epi32(args.mask);
+      size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        __m128 x = _mm_loadu_ps(phases + i);
+        if (args.normalize)
+        {
+          x = _mm_mul_ps(_mm_sub_ps(x, bias), scale);
+        }
+        x = _mm_mul_ps(x, size);
+        if (!args.periodic)
+        {
+          x = _mm_min_ps(_mm_max_ps(x, zero), size);
+        }
+        __m128 fl = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+        fl = _mm_sub_ps(fl, _mm_and_ps(_mm_cmpgt_ps(fl, x), one));
+        __m128i idx = _mm_and_si128(_mm_cvttps_epi32(fl), mask);
+        __m128 frac = _mm_sub_ps(x, fl);
+        // load each lane's pair of adjacent points, narrowed to single precision, then transpose them
+        __m128 p0 = _mm_cvtpd_ps(_mm_loadu_pd(args.table + _mm_cvtsi128_si32(idx)));
+        __m128 p1 = _mm_cvtpd_ps(_mm_loadu_pd(args.table + _mm_cvtsi128_si32(_mm_shuffle_epi32(idx, 1))));
+        __m128 p2 = _mm_cvtpd_ps(_mm_loadu_pd(args.table + _mm_cvtsi128_si32(_mm_shuffle_epi32(idx, 2))));
+        __m128 p3 = _mm_cvtpd_ps(_mm_loadu_pd(args.table + _mm_cvtsi128_si32(_mm_shuffle_epi32(idx, 3))));
+        __m128 p01 = _mm_unpacklo_ps(p0, p1);
+        __m128 p23 = _mm_unpacklo_ps(p2, p3);
+        __m128 a = _mm_movelh_ps(p01, p23);
+        __m128 b = _mm_movehl_ps(p23, p01);
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_mul_ps(_mm_sub_ps(b, a), frac), a));
+      }
+      for (; i < n; i++)
+      {
+        out[i] = float(lerp_scalar(args, phases[i]));
+      }
+    }
+
+    SYN_TARGET_AVX2 void lerp_kernel_avx2(const LerpArgs& args, const double* phases, double* out, size_t n)
+    {
+      const __m256d bias = _mm256_set1_pd(args.bias);
+      const __m256d scale = _mm256_set1_pd(args.scale);
+      const __m256d size = _mm256_set1_pd(args.span);
+      const __m256d zero = _mm256_setzero_pd();
+      const __m128i mask = _mm_set1_epi32(args.mask);
+      const __m128i one = _mm_set1_epi32(1);
+      size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        __m256d x = _mm256_loadu_pd(phases + i);
+        if (args.normalize)
+        {
+          x = _mm256_mul_pd(_mm256_sub_pd(x, bias), scale);
+        }
+        x = _mm256_mul_pd(x, size);
+        if (!args.periodic)
+        {
+          x = _mm256_min_pd(_mm256_max_pd(x, zero), size);
+        }
+        __m256d fl = _mm256_floor_pd(x);
+        __m128i idx = _mm_and_si128(_mm256_cvttpd_epi32(fl), mask);
+        __m256d frac = _mm256_sub_pd(x, fl);
+        __m256d a = _mm256_i32gather_pd(args.table, idx, 8);
+        __m256d b = _mm256_i32gather_pd(args.table, _mm_add_epi32(idx, one), 8);
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(b, a), frac), a));
+      }
+      for (; i < n; i++)
+      {
+        out[i] = lerp_scalar(args, phases[i]);
+      }
+    }
+
+    SYN_TARGET_AVX2 void lerp_kernel_avx2_f(const LerpArgs& args, const float* phases, float* out, size_t n)
+    {
+      const __m256 bias = _mm256_set1_ps(float(args.bias));
+      const __m256 scale = _mm256_set1_ps(float(args.scale));
+      const __m256 size = _mm256_set1_ps(float(args.span));
+      const __m256 zero = _mm256_setzero_ps();
+      const __m256i mask = _mm256_set1_epi32(args.mask);
+      const __m128i one = _mm_set1_epi32(1);
+      size_t i = 0;
+      for (; i + 8 <= n; i += 8)
+      {
+        __m256 x = _mm256_loadu_ps(phases + i);
+        if (args.normalize)
+        {
+          x = _mm256_mul_ps(_mm256_sub_ps(x, bias), scale);
+        }
+        x = _mm256_mul_ps(x, size);
+        if (!args.periodic)
+        {
+          x = _mm256_min_ps(_mm256_max_ps(x, zero), size);
+        }
+        __m256 fl = _mm256_floor_ps(x);
+        __m256i idx = _mm256_and_si256(_mm256_cvttps_epi32(fl), mask);
+        __m256 frac = _mm256_sub_ps(x, fl);
+        // the table is in double precision, so gather each half of the lanes separately and narrow the points
+        __m128i lo = _mm256_castsi256_si128(idx);
+        __m128i hi = _mm256_extracti128_si256(idx, 1);
+        __m256 a = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(_mm256_i32gather_pd(args.table, lo, 8))),
+                                        _mm256_cvtpd_ps(_mm256_i32gather_pd(args.table, hi, 8)), 1);
+        __m256 b = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(_mm256_i32gather_pd(args.table, _mm_add_epi32(lo, one), 8))),
+                                        _mm256_cvtpd_ps(_mm256_i32gather_pd(args.table, _mm_add_epi32(hi, one), 8)), 1);
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(b, a), frac), a));
+      }
+      for (; i < n; i++)
+      {
+        out[i] = float(lerp_scalar(args, phases[i]));
+      }
+    }
+
+    bool cpuHasAVX2()
+    {
+#if defined(_MSC_VER)
+      int info[4];
+      __cpuid(info, 0);
+      if (info[0] < 7)
+        return false;
+      __cpuid(info, 1);
+      bool osxsave = (info[2] & (1 << 27)) != 0;
+      bool avx = (info[2] & (1 << 28)) != 0;
+      if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+        return false;
+      __cpuidex(info, 7, 0);
+      return (info[1] & (1 << 5)) != 0;
+#else
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+
+    LerpKernel selectLerpKernel()
+    {
+#ifdef SYN_X86
+      if (cpuHasAVX2())
+        return lerp_kernel_avx2;
+      return lerp_kernel_sse2;
+#else
+      return lerp_kernel_scalar<double>;
+#endif
+    }
+
+    LerpKernelF selectLerpKernelF()
+    {
+#ifdef SYN_X86
+      if (cpuHasAVX2())
+        return lerp_kernel_avx2_f;
+      return lerp_kernel_sse2_f;
+#else
+      return lerp_kernel_scalar<float>;
+#endif
+    }
+
+    const LerpKernel lerp_kernel = selectLerpKernel();
+    const LerpKernelF lerp_kernel_f = selectLerpKernelF();
+  }
+
   double LookupTable::getlinear(double phase) const
+  {
+    if (m_mask)
+    {
+      LerpArgs args = { m_table, m_mask, getSpan(), m_isperiodic, m_normalizePhase, m_norm_bias, m_norm_scale };
+      return lerp_scalar(args, phase);
+    }
+    return getlinear_generic(phase);
+  }
+
+  void LookupTable::getlinear(const double* phases, double* out, size_t n) const
+  {
+    if (m_mask)
+    {
+      LerpArgs args = { m_table, m_mask, getSpan(), m_isperiodic, m_normalizePhase, m_norm_bias, m_norm_scale };
+      lerp_kernel(args, phases, out, n);
+    }
+    else
+    {
+      for (int i = 0; i < n; i++)
+      {
+        out[i] = getlinear_generic(phases[i]);
+      }
+    }
+  }
+
+  void LookupTable::getlinear(const float* phases, float* out, size_t n) const
+  {
+    if (m_mask)
+    {
+      LerpArgs args = { m_table, m_mask, getSpan(), m_isperiodic, m_normalizePhase, m_norm_bias, m_norm_scale };
+      lerp_kernel_f(args, phases, out, n);
+    }
+    else
+    {
+      for (int i = 0; i < n; i++)
+      {
+        out[i] = float(getlinear_generic(phases[i]));
+      }
+    }
+  }
+
+  double LookupTable::getlinear_generic(double phase) const
   {
     if (m_normalizePhase)
     {
       phase = (phase - m_norm_bias)*m_norm_scale;
     }
-    phase *= (m_size - 1);
+    phase *= getSpan();
     while (phase >= m_size) {
       if (m_isperiodic) phase -= m_size;
       else phase = m_size - 1;
@@ -27,4 +351,339 @@ namespace syn
     double val2 = m_table[next_int_index];
     return LERP(val1, val2, frac_index);
   }
-}
\ No newline at end of file
+
+  MipmappedTable::MipmappedTable(const double* data, int numLevels, int minSize, int oversampling)
+  {
+    m_levels.reserve(numLevels);
+    for (int k = 0; k < numLevels; k++)
+    {
+      int size = getLevelSize(k, minSize, oversampling);
+      m_levels.push_back(LookupTable(data, size, 0, 1, true, true));
+      data += size + 1;
+    }
+  }
+
+  int MipmappedTable::getLevelSize(int level, int minSize, int oversampling)
+  {
+    return std::max(minSize, oversampling << level);
+  }
+
+  size_t MipmappedTable::getDataSize(int numLevels, int minSize, int oversampling)
+  {
+    size_t total = 0;
+    for (int k = 0; k < numLevels; k++)
+    {
+      total += getLevelSize(k, minSize, oversampling) + 1;
+    }
+    return total;
+  }
+
+  void MipmappedTable::generate(double* data, double(*harmonic)(int k), int numLevels, int minSize, int oversampling)
+  {
+    const double pi = 3.14159265358979323846;
+    for (int k = 0; k < numLevels; k++)
+    {
+      int size = getLevelSize(k, minSize, oversampling);
+      std::vector<double> sine(size);
+      for (int i = 0; i < size; i++)
+      {
+        sine[i] = std::sin(2 * pi * i / size);
+      }
+      std::fill(data, data + size, 0.0);
+      for (int h = 1; h <= (1 << k); h++)
+      {
+        double amp = harmonic(h);
+        for (int i = 0; i < size; i++)
+        {
+          data[i] += amp * sine[(size_t(h) * i) & (size - 1)];
+        }
+      }
+      data[size] = data[0];
+      data += size + 1;
+    }
+  }
+
+  int MipmappedTable::getLevel(double step) const
+  {
+    if (!(step > 0))
+      return m_levels.size() - 1;
+    int level = int(std::floor(std::log2(0.5 / step)));
+    return level < 0 ? 0 : (level >= int(m_levels.size()) ? m_levels.size() - 1 : level);
+  }
+
+  /******************************
+  * TableStore methods
+  *
+  ******************************/
+
+  namespace
+  {
+#define TABLE_FILE_VERSION 1
+#define TABLE_DATA_OFFSET 64 //!< byte offset of the first table, which keeps the tables cache line aligned
+
+    /**
+     * Leading bytes of the table memory and of its cache file. A cache file is only used if its header is identical
+     * to the one the current configuration would produce.
+     */
+    struct TableFileHeader
+    {
+      char magic[8];
+      uint32_t version;
+      uint32_t headerSize;
+      uint64_t size; //!< bytes in the header and tables together
+      int32_t config[5];
+      int32_t reserved;
+      double check; //!< a known value, so that files written with a different double layout are rejected
+    };
+    static_assert(sizeof(TableFileHeader) <= TABLE_DATA_OFFSET, "table header overlaps the tables");
+
+    TableConfig g_tableConfig;
+    std::string g_tableCachePath;
+    std::atomic<bool> g_tablesBuilt(false);
+
+    bool isPowerOfTwo(int x)
+    {
+      return x > 1 && (x & (x - 1)) == 0;
+    }
+
+    double sawHarmonic(int k)
+    {
+      return -2 / (3.14159265358979323846 * k);
+    }
+
+    void generateSine(double* table, int size)
+    {
+      const double pi = 3.14159265358979323846;
+      for (int i = 0; i < size; i++)
+      {
+        table[i] = std::sin(2 * pi * i / size);
+      }
+      table[size] = table[0];
+    }
+
+    void generatePitchTable(double* table, int size)
+    {
+      for (int i = 0; i < size; i++)
+      {
+        double pitch = -128 + 256.0 * i / (size - 1);
+        table[i] = 440 * std::pow(2.0, (pitch - 69) / 12);
+      }
+      table[size] = table[size - 1];
+    }
+
+    size_t getPageSize()
+    {
+#ifdef _WIN32
+      SYSTEM_INFO info;
+      GetSystemInfo(&info);
+      return info.dwPageSize;
+#else
+      return size_t(sysconf(_SC_PAGESIZE));
+#endif
+    }
+
+    /**
+     * Allocates zeroed, page-aligned memory that can be write protected afterwards.
+     */
+    void* allocatePages(size_t size)
+    {
+#ifdef _WIN32
+      return VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else
+      void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      return mem == MAP_FAILED ? nullptr : mem;
+#endif
+    }
+
+    void protectPages(void* mem, size_t size)
+    {
+#ifdef _WIN32
+      DWORD oldProtect;
+      VirtualProtect(mem, size, PAGE_READONLY, &oldProtect);
+#else
+      mprotect(mem, size, PROT_READ);
+#endif
+    }
+
+    void releasePages(void* mem, size_t size)
+    {
+#ifdef _WIN32
+      VirtualFree(mem, 0, MEM_RELEASE);
+#else
+      munmap(mem, size);
+#endif
+    }
+
+    /**
+     * Maps a whole file read-only. Returns null if the file cannot be opened or mapped.
+     */
+    void* mapFile(const std::string& path, size_t& size)
+    {
+#ifdef _WIN32
+      HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+      if (file == INVALID_HANDLE_VALUE)
+        return nullptr;
+      LARGE_INTEGER filesize;
+      void* mem = nullptr;
+      if (GetFileSizeEx(file, &filesize) && filesize.QuadPart > 0)
+      {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping)
+        {
+          mem = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+          CloseHandle(mapping);
+        }
+        size = size_t(filesize.QuadPart);
+      }
+      CloseHandle(file);
+      return mem;
+#else
+      int fd = open(path.c_str(), O_RDONLY);
+      if (fd < 0)
+        return nullptr;
+      struct stat st;
+      void* mem = nullptr;
+      if (fstat(fd, &st) == 0 && st.st_size > 0)
+      {
+        size = size_t(st.st_size);
+        mem = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (mem == MAP_FAILED)
+          mem = nullptr;
+      }
+      close(fd);
+      return mem;
+#endif
+    }
+
+    void unmapFile(void* mem, size_t size)
+    {
+#ifdef _WIN32
+      UnmapViewOfFile(mem);
+#else
+      munmap(mem, size);
+#endif
+    }
+
+    /**
+     * Writes the tables to a temporary file, then moves it over the cache file, so that other processes never map a
+     * partially written cache. Failures are ignored, since the cache only saves startup time.
+     */
+    void writeCacheFile(const std::string& path, const void* mem, size_t size)
+    {
+      std::string tmppath = path + ".tmp" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+      {
+        std::ofstream file(tmppath, std::ios::binary | std::ios::trunc);
+        if (!file)
+          return;
+        file.write(static_cast<const char*>(mem), size);
+        if (!file)
+        {
+          file.close();
+          std::remove(tmppath.c_str());
+          return;
+        }
+      }
+      if (std::rename(tmppath.c_str(), path.c_str()) != 0)
+      {
+        // rename does not replace an existing file on every platform
+        std::remove(path.c_str());
+        if (std::rename(tmppath.c_str(), path.c_str()) != 0)
+          std::remove(tmppath.c_str());
+      }
+    }
+  }
+
+  void TableStore::configure(const TableConfig& config, const std::string& cachePath)
+  {
+    if (!isPowerOfTwo(config.sineSize) || !isPowerOfTwo(config.pitchSize) || !isPowerOfTwo(config.blSawMinSize)
+      || !isPowerOfTwo(config.blSawOversampling) || config.blSawLevels < 1 || config.blSawLevels > 20)
+      throw std::invalid_argument("Table sizes must be powers of two, with 1 to 20 saw mipmap levels.");
+    if (g_tablesBuilt)
+    {
+      if (config == g_tableConfig && cachePath == g_tableCachePath)
+        return;
+      throw std::logic_error("The lookup tables were already built with different settings.");
+    }
+    g_tableConfig = config;
+    g_tableCachePath = cachePath;
+  }
+
+  const TableStore& TableStore::get()
+  {
+    static const TableStore store(g_tableConfig, g_tableCachePath);
+    return store;
+  }
+
+  TableStore::TableStore(const TableConfig& config, const std::string& cachePath) :
+    m_config(config),
+    m_memory(nullptr),
+    m_memorySize(0),
+    m_isMapped(false)
+  {
+    g_tablesBuilt = true;
+    size_t sineOffset = 0;
+    size_t pitchOffset = sineOffset + config.sineSize + 1;
+    size_t sawOffset = pitchOffset + config.pitchSize + 1;
+    size_t numPoints = sawOffset + MipmappedTable::getDataSize(config.blSawLevels, config.blSawMinSize, config.blSawOversampling);
+    size_t size = TABLE_DATA_OFFSET + numPoints * sizeof(double);
+
+    TableFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "SYNTABLE", sizeof(header.magic));
+    header.version = TABLE_FILE_VERSION;
+    header.headerSize = TABLE_DATA_OFFSET;
+    header.size = size;
+    header.config[0] = config.sineSize;
+    header.config[1] = config.pitchSize;
+    header.config[2] = config.blSawLevels;
+    header.config[3] = config.blSawMinSize;
+    header.config[4] = config.blSawOversampling;
+    header.check = 1.0 / 3.0;
+
+    if (!cachePath.empty())
+    {
+      size_t filesize = 0;
+      void* mem = mapFile(cachePath, filesize);
+      if (mem && filesize == size && memcmp(mem, &header, sizeof(header)) == 0)
+      {
+        m_memory = mem;
+        m_memorySize = size;
+        m_isMapped = true;
+      }
+      else if (mem)
+      {
+        unmapFile(mem, filesize);
+      }
+    }
+
+    if (!m_isMapped)
+    {
+      size_t pagesize = getPageSize();
+      m_memorySize = (size + pagesize - 1) / pagesize * pagesize;
+      m_memory = allocatePages(m_memorySize);
+      if (!m_memory)
+        throw std::bad_alloc();
+      memcpy(m_memory, &header, sizeof(header));
+      double* data = reinterpret_cast<double*>(static_cast<char*>(m_memory) + TABLE_DATA_OFFSET);
+      generateSine(data + sineOffset, config.sineSize);
+      generatePitchTable(data + pitchOffset, config.pitchSize);
+      MipmappedTable::generate(data + sawOffset, sawHarmonic, config.blSawLevels, config.blSawMinSize, config.blSawOversampling);
+      protectPages(m_memory, m_memorySize);
+      if (!cachePath.empty())
+        writeCacheFile(cachePath, m_memory, size);
+    }
+
+    const double* data = reinterpret_cast<const double*>(static_cast<const char*>(m_memory) + TABLE_DATA_OFFSET);
+    m_sine = LookupTable(data + sineOffset, config.sineSize, 0, 1, true, true);
+    m_pitchTable = LookupTable(data + pitchOffset, config.pitchSize, -1, 1, false, true);
+    m_blSaw = MipmappedTable(data + sawOffset, config.blSawLevels, config.blSawMinSize, config.blSawOversampling);
+  }
+
+  TableStore::~TableStore()
+  {
+    if (m_isMapped)
+      unmapFile(m_memory, m_memorySize);
+    else
+      releasePages(m_memory, m_memorySize);
+  }
+}
@@ -1,14 +1,29 @@
 #ifndef __TABLES__
 #define __TABLES__
+#include <cstddef>
+#include <string>
+#include <vector>
 #define LERP(A,B,F) (((B)-(A))*(F)+(A))
 
-//todo: add oversampling and bias info to the LookupTable class so that it can still be accessed with a double between some arbitrary min and max.
 namespace syn
 {
+  /**
+   * \class LookupTable
+   *
+   * \brief Linearly interpolated read access to a table of samples.
+   *
+   * Tables whose size is a power of two and which are stored with one extra guard point (a copy of the first sample for
+   * periodic tables, of the last sample otherwise) use a fast path in which index wrapping reduces to a bit mask and
+   * the next index never needs to be wrapped. The batch versions of getlinear additionally use SSE2 or AVX2 kernels
+   * when the CPU supports them.
+   *
+   * A periodic table of size N holds one period in N points, so a phase of 1 maps to index N. Any other table spans the
+   * input range with its N points, so input_max maps to index N-1.
+   */
   class LookupTable
   {
   public:
-    LookupTable(const double* table, int size, double input_min = 0, double input_max = 1, bool isPeriodic = true) :
+    LookupTable(const double* table, int size, double input_min = 0, double input_max = 1, bool isPeriodic = true, bool hasGuardPoint = false) :
       m_table(table),
       m_size(size),
       m_isperiodic(isPeriodic)
@@ -16,28 +31,200 @@ namespace syn
       m_norm_bias = input_min;
       m_norm_scale = 1. / (input_max - input_min);
       m_normalizePhase = (m_norm_bias != 0 && m_norm_scale != 1);
+      m_mask = (hasGuardPoint && size > 0 && (size & (size - 1)) == 0) ? size - 1 : 0;
     }
     LookupTable() :
       LookupTable(nullptr, 0, 0, 1)
     {}
     double getlinear(const double phase) const;
+    /**
+     * \brief Interpolates the table at each of the n given phases. phases and out may point to the same buffer.
+     */
+    void getlinear(const double* phases, double* out, size_t n) const;
+    /**
+     * \brief Single precision version of the batch getlinear, which processes twice as many phases per instruction.
+     */
+    void getlinear(const float* phases, float* out, size_t n) const;
   private:
+    double getlinear_generic(double phase) const;
+    double getSpan() const
+    {
+      return m_isperiodic ? m_size : m_size - 1;
+    }
     int m_size;
+    int m_mask; //!< m_size-1 if the table has the power-of-two, guard point padded layout, otherwise 0
     bool m_normalizePhase, m_isperiodic;
     double m_norm_bias;
     double m_norm_scale;
     const double* m_table;
   };
 
-  /*::automated::*/
-  extern const double BL_SAW[256];
-extern const double PITCH_TABLE[256];
-extern const double SIN[1024];
+  /**
+   * \class MipmappedTable
+   *
+   * \brief Band-limited versions of a periodic waveform, one per octave of fundamental frequency.
+   *
+   * Level k holds harmonics 1 through 2^k of the waveform, so it can be played back without aliasing as long as the
+   * phase increment stays at or below 2^-(k+1). Each level is a power-of-two, guard point padded LookupTable, so blocks
+   * of phases are read with the SIMD getlinear kernels. The levels do not own their points, which live in the
+   * TableStore shared by every voice.
+   */
+  class MipmappedTable
+  {
+  public:
+    MipmappedTable()
+    {}
+    /**
+     * \param data Points laid out by generate(), which must outlive the table
+     * \param numLevels Number of octaves, so the richest level holds 2^(numLevels-1) harmonics
+     * \param minSize Size of the smallest level
+     * \param oversampling Points per period of the highest harmonic of each level that is larger than minSize
+     */
+    MipmappedTable(const double* data, int numLevels, int minSize, int oversampling);
+    /**
+     * \brief Number of points generate() writes for the given layout.
+     */
+    static size_t getDataSize(int numLevels, int minSize, int oversampling);
+    /**
+     * \brief Writes every level of the waveform whose k-th harmonic is a sine of amplitude harmonic(k) into data.
+     */
+    static void generate(double* data, double(*harmonic)(int k), int numLevels, int minSize, int oversampling);
+    /**
+     * \brief Returns the richest level whose harmonics all stay below the Nyquist frequency at the given phase increment.
+     */
+    int getLevel(double step) const;
+    const LookupTable& getTable(int level) const
+    {
+      return m_levels[level];
+    }
+    int getNumLevels() const
+    {
+      return m_levels.size();
+    }
+    int getMaxHarmonic() const
+    {
+      return 1 << (m_levels.size() - 1);
+    }
+  private:
+    static int getLevelSize(int level, int minSize, int oversampling);
+    std::vector<LookupTable> m_levels;
+  };
+
+  /**
+   * \brief Resolution of the tables in a TableStore. Every size must be a power of two.
+   */
+  struct TableConfig
+  {
+    TableConfig() :
+      sineSize(1024),
+      pitchSize(256),
+      blSawLevels(11),
+      blSawMinSize(256),
+      blSawOversampling(8)
+    {}
 
-const LookupTable lut_bl_saw(BL_SAW, 256);
-const LookupTable lut_pitch_table(PITCH_TABLE, 256, -1, 1, false);
-const LookupTable lut_sin(SIN, 1024);
+    bool operator==(const TableConfig& other) const
+    {
+      return sineSize == other.sineSize && pitchSize == other.pitchSize && blSawLevels == other.blSawLevels
+        && blSawMinSize == other.blSawMinSize && blSawOversampling == other.blSawOversampling;
+    }
+
+    int sineSize; //!< points in one period of the sine
+    int pitchSize; //!< points of the pitch to frequency table, which spans pitches -128 to 128
+    int blSawLevels; //!< octaves in the band-limited saw mipmap
+    int blSawMinSize; //!< points in the smallest level of the saw mipmap
+    int blSawOversampling; //!< points per period of the highest harmonic in the larger levels of the saw mipmap
+  };
 
-  /*::/automated::*/
+  /**
+   * \class TableStore
+   *
+   * \brief The lookup tables, generated when they are first used and shared read-only by every voice.
+   *
+   * All tables live in a single page-aligned block of memory, which is write protected once the tables are filled in.
+   * If a cache file is configured, the block is written to it, and later runs map the file instead of generating the
+   * tables again. A cache file written with a different configuration, version or floating point layout is ignored
+   * and rewritten.
+   */
+  class TableStore
+  {
+  public:
+    /**
+     * \brief Sets the resolution of the tables and the path of their cache file (none if empty).
+     *
+     * Throws std::invalid_argument if the configuration is invalid, and std::logic_error if the tables were already
+     * built with different settings.
+     */
+    static void configure(const TableConfig& config, const std::string& cachePath = "");
+    /**
+     * \brief Returns the shared tables, building or mapping them on the first call.
+     *
+     * Building them takes tens of milliseconds, so applications call this once at startup, off the audio thread,
+     * rather than leaving it to the first lut_*() call of a unit.
+     */
+    static const TableStore& get();
+
+    ~TableStore();
+
+    const LookupTable& getSine() const
+    {
+      return m_sine;
+    }
+    const LookupTable& getPitchTable() const
+    {
+      return m_pitchTable;
+    }
+    const MipmappedTable& getBLSaw() const
+    {
+      return m_blSaw;
+    }
+    const TableConfig& getConfig() const
+    {
+      return m_config;
+    }
+    /**
+     * \brief Whether the tables were mapped from the cache file rather than generated.
+     */
+    bool isMapped() const
+    {
+      return m_isMapped;
+    }
+  private:
+    TableStore(const TableConfig& config, const std::string& cachePath);
+    TableStore(const TableStore&) = delete;
+    TableStore& operator=(const TableStore&) = delete;
+
+    TableConfig m_config;
+    void* m_memory; //!< header followed by every table
+    size_t m_memorySize;
+    bool m_isMapped;
+    LookupTable m_sine;
+    LookupTable m_pitchTable;
+    MipmappedTable m_blSaw;
+  };
+
+  /**
+   * \brief One period of a sine, for phases from 0 to 1.
+   */
+  inline const LookupTable& lut_sin()
+  {
+    return TableStore::get().getSine();
+  }
+
+  /**
+   * \brief Frequency in Hz of pitches from -128 to 128, for inputs from -1 to 1.
+   */
+  inline const LookupTable& lut_pitch_table()
+  {
+    return TableStore::get().getPitchTable();
+  }
+
+  /**
+   * \brief Band-limited saw rising from -1 to 1, for phases from 0 to 1.
+   */
+  inline const MipmappedTable& lut_bl_saw()
+  {
+    return TableStore::get().getBLSaw();
+  }
 }
-#endif
\ No newline at end of file
+#endif